@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * Selects the benchmark backend. By default, the self-contained runner in `runner.h` is used.
+ * If `EASY_ITERATOR_GOOGLE_BENCHMARK` is defined, benchmarks are compiled against Google Benchmark instead.
+ * Benchmarks should only use the subset of the Google Benchmark API that is provided by `runner.h`.
+ */
+
+#ifdef EASY_ITERATOR_GOOGLE_BENCHMARK
+
+#include <benchmark/benchmark.h>
+
+#else
+
+#include "runner.h"
+
+namespace benchmark = easy_iterator::benchmark;
+
+#define BENCHMARK(function) EASY_ITERATOR_BENCHMARK(function)
+#define BENCHMARK_MAIN() EASY_ITERATOR_BENCHMARK_MAIN()
+
+#endif
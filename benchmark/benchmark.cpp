@@ -1,4 +1,4 @@
-#include <benchmark/benchmark.h>
+#include "backend.h"
 #include <easy_iterator.h>
 
 #ifdef COMPARE_WITH_ITERTOOLS
@@ -98,7 +98,7 @@ BENCHMARK(IterRangeLoop);
 
 Integer __attribute__((noinline)) forLoop(Integer max){
   Integer result = 0;
-  for (auto i=0; i<max+1; ++i) {
+  for (Integer i=0; i<max+1; ++i) {
     result += i;
   }
   return result;
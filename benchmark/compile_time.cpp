@@ -0,0 +1,86 @@
+/**
+ * Measures the compile time of `zip` instantiations with 2 to 16 arguments.
+ * For every arity a translation unit is generated that instantiates and iterates several distinct zips.
+ * The unit is compiled with `-fsyntax-only` and the median wall time of all repetitions is reported.
+ * Usage: EasyIteratorCompileTimeBenchmark [repetitions] [instances per unit]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef EASY_ITERATOR_CXX_COMPILER
+#define EASY_ITERATOR_CXX_COMPILER "c++"
+#endif
+
+#ifndef EASY_ITERATOR_INCLUDE_DIR
+#define EASY_ITERATOR_INCLUDE_DIR "include"
+#endif
+
+std::string zipSource(unsigned arity, unsigned instances){
+  std::stringstream source;
+  source << "#include <easy_iterator.h>\n#include <vector>\n\n";
+  source << "template <unsigned Instance, unsigned Idx> struct Element { int value; };\n\n";
+  source << "template <unsigned Instance> int sum(";
+  for (unsigned i = 0; i < arity; ++i) {
+    source << (i ? ", " : "") << "std::vector<Element<Instance, " << i << ">> &c" << i;
+  }
+  source << ") {\n  int result = 0;\n  for (auto [";
+  for (unsigned i = 0; i < arity; ++i) {
+    source << (i ? ", " : "") << "v" << i;
+  }
+  source << "]: easy_iterator::zip(";
+  for (unsigned i = 0; i < arity; ++i) {
+    source << (i ? ", " : "") << "c" << i;
+  }
+  source << ")) {\n    result += ";
+  for (unsigned i = 0; i < arity; ++i) {
+    source << (i ? " + " : "") << "v" << i << ".value";
+  }
+  source << ";\n  }\n  return result;\n}\n\n";
+  for (unsigned instance = 0; instance < instances; ++instance) {
+    source << "template int sum<" << instance << ">(";
+    for (unsigned i = 0; i < arity; ++i) {
+      source << (i ? ", " : "") << "std::vector<Element<" << instance << ", " << i << ">> &";
+    }
+    source << ");\n";
+  }
+  return source.str();
+}
+
+double compileMilliseconds(const std::string &file){
+  std::string command = std::string(EASY_ITERATOR_CXX_COMPILER) + " -std=c++17 -fsyntax-only -w -I\"" + EASY_ITERATOR_INCLUDE_DIR + "\" \"" + file + "\"";
+  auto start = std::chrono::steady_clock::now();
+  if (std::system(command.c_str()) != 0) {
+    throw std::runtime_error("compilation failed: " + command);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char ** argv){
+  unsigned repetitions = argc > 1 ? std::stoul(argv[1]) : 5;
+  unsigned instances = argc > 2 ? std::stoul(argv[2]) : 20;
+
+  std::cout << "arity\tmedian [ms]\tmin [ms]" << std::endl;
+  for (unsigned arity = 2; arity <= 16; ++arity) {
+    std::string file = "easy_iterator_compile_time_zip_" + std::to_string(arity) + ".cpp";
+    std::ofstream(file) << zipSource(arity, instances);
+    std::vector<double> times;
+    for (unsigned r = 0; r < repetitions; ++r) {
+      times.push_back(compileMilliseconds(file));
+    }
+    std::sort(times.begin(), times.end());
+    std::cout << arity << "\t" << times[times.size() / 2] << "\t" << times.front() << std::endl;
+    std::remove(file.c_str());
+  }
+
+  return 0;
+}
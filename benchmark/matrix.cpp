@@ -0,0 +1,273 @@
+/**
+ * Benchmarks every iteration pattern over a matrix of element types and sizes from L1 to DRAM.
+ * Each pattern is measured next to its handwritten baseline and reported in ns/element, GB/s and
+ * bytes/cycle together with the ratio to the baseline.
+ *
+ * Cycles are measured with the time stamp counter where available.
+ *
+ * Additional command line options (all runner options are also accepted, repetitions default to 5):
+ *   --min_size=<n>    smallest number of elements (default: 1000)
+ *   --max_size=<n>    largest number of elements (default: 1000000000)
+ *   --max_bytes=<n>   skip cases that would allocate more memory (default: 1073741824)
+ */
+
+#include "runner.h"
+#include <easy_iterator.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace easy_iterator;
+using benchmark::DoNotOptimize;
+
+struct Line {
+  uint64_t words[8];
+};
+
+template <class T> struct TypeName;
+template <> struct TypeName<uint8_t> { static constexpr const char * value = "u8"; };
+template <> struct TypeName<int32_t> { static constexpr const char * value = "i32"; };
+template <> struct TypeName<float> { static constexpr const char * value = "f32"; };
+template <> struct TypeName<double> { static constexpr const char * value = "f64"; };
+template <> struct TypeName<Line> { static constexpr const char * value = "line64"; };
+
+template <class T> using Accumulator = typename std::conditional<std::is_floating_point<T>::value, double, uint64_t>::type;
+
+template <class T> inline void add(Accumulator<T> &acc, const T &v){ acc += v; }
+inline void add(uint64_t &acc, const Line &v){
+  for (auto w: v.words) { acc += w; }
+}
+
+template <class T> T makeValue(size_t i){ return static_cast<T>(i & 0x7f); }
+template <> Line makeValue<Line>(size_t i){
+  Line line;
+  for (auto &w: line.words) { w = i; }
+  return line;
+}
+
+// ---- kernels ----
+
+template <class T> Accumulator<T> __attribute__((noinline)) easyArray(const std::vector<T> &values){
+  Accumulator<T> acc = 0;
+  for (auto &v: valuesBetween(values.data(), values.data() + values.size())) { add(acc, v); }
+  return acc;
+}
+
+template <class T> Accumulator<T> __attribute__((noinline)) rawArray(const std::vector<T> &values){
+  Accumulator<T> acc = 0;
+  auto data = values.data();
+  for (size_t i = 0, n = values.size(); i < n; ++i) { add(acc, data[i]); }
+  return acc;
+}
+
+template <class T> Accumulator<T> __attribute__((noinline)) easyZip(const std::vector<T> &a, const std::vector<T> &b){
+  Accumulator<T> acc = 0;
+  for (auto [x, y]: zip(a, b)) { add(acc, x); add(acc, y); }
+  return acc;
+}
+
+template <class T> Accumulator<T> __attribute__((noinline)) rawZip(const std::vector<T> &a, const std::vector<T> &b){
+  Accumulator<T> acc = 0;
+  auto x = a.data(), y = b.data();
+  for (size_t i = 0, n = a.size(); i < n; ++i) { add(acc, x[i]); add(acc, y[i]); }
+  return acc;
+}
+
+template <class T> Accumulator<T> __attribute__((noinline)) easyEnumerate(const std::vector<T> &values){
+  Accumulator<T> acc = 0;
+  uint64_t indices = 0;
+  for (auto [i, v]: enumerate(values)) { add(acc, v); indices += i; }
+  return acc + static_cast<Accumulator<T>>(indices & 1);
+}
+
+template <class T> Accumulator<T> __attribute__((noinline)) rawEnumerate(const std::vector<T> &values){
+  Accumulator<T> acc = 0;
+  uint64_t indices = 0;
+  uint64_t i = 0;
+  for (auto &v: values) { add(acc, v); indices += i; ++i; }
+  return acc + static_cast<Accumulator<T>>(indices & 1);
+}
+
+template <class T> Accumulator<T> __attribute__((noinline)) easyUnroll(const std::vector<T> &values){
+  Accumulator<T> acc = 0;
+  unroll<4>(values, [&](const T &v){ add(acc, v); });
+  return acc;
+}
+
+uint64_t __attribute__((noinline)) easyRange(uint64_t n){
+  uint64_t acc = 0;
+  for (auto i: range(n)) { acc += i ^ (acc >> 3); }
+  return acc;
+}
+
+uint64_t __attribute__((noinline)) rawRange(uint64_t n){
+  uint64_t acc = 0;
+  for (uint64_t i = 0; i < n; ++i) { acc += i ^ (acc >> 3); }
+  return acc;
+}
+
+struct CustomRange: public InitializedIterable {
+  uint64_t current = 0, max;
+  explicit CustomRange(uint64_t _max):max(_max){ }
+  bool init(){ return current != max; }
+  bool advance(){ ++current; return current != max; }
+  uint64_t value(){ return current; }
+};
+
+uint64_t __attribute__((noinline)) easyCustomRange(uint64_t n){
+  uint64_t acc = 0;
+  for (auto i: MakeIterable<CustomRange>(n)) { acc += i ^ (acc >> 3); }
+  return acc;
+}
+
+// ---- matrix ----
+
+struct Case {
+  std::string pattern;
+  std::string type;
+  size_t elements;
+  size_t bytesPerElement;
+  size_t allocatedBytes;
+  std::function<void(benchmark::State &)> easy;
+  std::function<void(benchmark::State &)> baseline;
+  std::function<void()> release;
+};
+
+struct Config {
+  size_t minSize = 1000;
+  size_t maxSize = 1000000000;
+  size_t maxBytes = size_t(1) << 30;
+};
+
+template <class T> void addTypedCases(std::vector<Case> &cases, size_t n){
+  auto a = std::make_shared<std::vector<T>>();
+  auto b = std::make_shared<std::vector<T>>();
+  // vectors are filled lazily, so cases that are filtered out do not allocate memory
+  auto single = [=](){ if (a->size() != n) { a->resize(n); copy(range(n), *a, makeValue<T>); } return a; };
+  auto both = [=](){ single(); if (b->size() != n) { b->resize(n); copy(range(n), *b, makeValue<T>); } return std::make_pair(a, b); };
+  auto release = [=](){ std::vector<T>().swap(*a); std::vector<T>().swap(*b); };
+  std::string type = TypeName<T>::value;
+
+  auto unary = [&](const std::string &pattern, auto easy, auto baseline){
+    cases.push_back({pattern, type, n, sizeof(T), n * sizeof(T),
+      [=](benchmark::State &state){ auto v = single(); for (auto _: state) { DoNotOptimize(easy(*v)); } },
+      [=](benchmark::State &state){ auto v = single(); for (auto _: state) { DoNotOptimize(baseline(*v)); } },
+      release
+    });
+  };
+
+  unary("array", easyArray<T>, rawArray<T>);
+  unary("enumerate", easyEnumerate<T>, rawEnumerate<T>);
+  unary("unroll", easyUnroll<T>, rawArray<T>);
+  cases.push_back({"zip", type, n, 2 * sizeof(T), 2 * n * sizeof(T),
+    [=](benchmark::State &state){ auto v = both(); for (auto _: state) { DoNotOptimize(easyZip(*v.first, *v.second)); } },
+    [=](benchmark::State &state){ auto v = both(); for (auto _: state) { DoNotOptimize(rawZip(*v.first, *v.second)); } },
+    release
+  });
+}
+
+std::vector<Case> makeCases(const Config &config){
+  std::vector<Case> cases;
+  for (size_t n = config.minSize; n <= config.maxSize; n *= 10) {
+    cases.push_back({"range", "u64", n, 0, 0,
+      [=](benchmark::State &state){ for (auto _: state) { DoNotOptimize(easyRange(n)); } },
+      [=](benchmark::State &state){ for (auto _: state) { DoNotOptimize(rawRange(n)); } },
+      [](){ }
+    });
+    cases.push_back({"custom range", "u64", n, 0, 0,
+      [=](benchmark::State &state){ for (auto _: state) { DoNotOptimize(easyCustomRange(n)); } },
+      [=](benchmark::State &state){ for (auto _: state) { DoNotOptimize(rawRange(n)); } },
+      [](){ }
+    });
+    addTypedCases<uint8_t>(cases, n);
+    addTypedCases<int32_t>(cases, n);
+    addTypedCases<float>(cases, n);
+    addTypedCases<double>(cases, n);
+    addTypedCases<Line>(cases, n);
+  }
+  return cases;
+}
+
+/**
+ * Returns the number of time stamp counter ticks per nanosecond, or 0 if unavailable.
+ */
+double cyclesPerNanosecond(){
+#if defined(__x86_64__) || defined(__i386__)
+  auto start = benchmark::Clock::now();
+  auto startTicks = __rdtsc();
+  while (benchmark::Clock::now() - start < std::chrono::milliseconds(100)) { }
+  auto ticks = __rdtsc() - startTicks;
+  return ticks / std::chrono::duration<double, std::nano>(benchmark::Clock::now() - start).count();
+#else
+  return 0;
+#endif
+}
+
+int main(int argc, char ** argv){
+  Config config;
+  std::vector<char *> runnerArguments{argv[0]};
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("--min_size=", 0) == 0) { config.minSize = std::stoull(arg.substr(11)); }
+    else if (arg.rfind("--max_size=", 0) == 0) { config.maxSize = std::stoull(arg.substr(11)); }
+    else if (arg.rfind("--max_bytes=", 0) == 0) { config.maxBytes = std::stoull(arg.substr(12)); }
+    else { runnerArguments.push_back(argv[i]); }
+  }
+  auto options = benchmark::parseOptions(static_cast<int>(runnerArguments.size()), runnerArguments.data());
+  bool repetitionsSet = false;
+  for (auto arg: runnerArguments) { repetitionsSet |= std::string(arg).rfind("--repetitions=", 0) == 0; }
+  if (!repetitionsSet) { options.repetitions = 5; }
+  auto cycles = cyclesPerNanosecond();
+
+  std::ofstream file;
+  if (!options.out.empty()) { file.open(options.out); }
+  std::ostream &stream = options.out.empty() ? std::cout : file;
+
+  if (options.json) {
+    stream << "{\n  \"cycles_per_ns\": " << cycles << ",\n  \"results\": [";
+  } else {
+    stream << std::left << std::setw(14) << "pattern" << std::setw(8) << "type" << std::right << std::setw(12) << "elements"
+      << std::setw(14) << "ns/element" << std::setw(14) << "baseline" << std::setw(8) << "ratio"
+      << std::setw(10) << "GB/s" << std::setw(12) << "bytes/cycle" << std::endl;
+  }
+
+  bool first = true;
+  for (auto &c: makeCases(config)) {
+    auto name = c.pattern + "/" + c.type + "/" + std::to_string(c.elements);
+    if (name.find(options.filter) == std::string::npos || c.allocatedBytes > config.maxBytes) { continue; }
+    auto easy = benchmark::measure(name, c.easy, {}, options);
+    auto baseline = benchmark::measure(name + "/baseline", c.baseline, {}, options);
+    c.release();
+    double nsPerElement = easy.medianNs / c.elements;
+    double baselineNsPerElement = baseline.medianNs / c.elements;
+    double bytesPerNs = c.bytesPerElement / nsPerElement;
+    double bytesPerCycle = cycles > 0 ? bytesPerNs / cycles : 0;
+
+    stream << std::fixed << std::setprecision(3);
+    if (options.json) {
+      stream << (first ? "" : ",") << "\n    {\"pattern\": \"" << c.pattern << "\", \"type\": \"" << c.type
+        << "\", \"elements\": " << c.elements << ", \"ns_per_element\": " << nsPerElement
+        << ", \"baseline_ns_per_element\": " << baselineNsPerElement << ", \"ratio\": " << nsPerElement / baselineNsPerElement
+        << ", \"gb_per_second\": " << bytesPerNs << ", \"bytes_per_cycle\": " << bytesPerCycle << "}";
+    } else {
+      stream << std::left << std::setw(14) << c.pattern << std::setw(8) << c.type << std::right << std::setw(12) << c.elements
+        << std::setw(14) << nsPerElement << std::setw(14) << baselineNsPerElement << std::setw(8) << nsPerElement / baselineNsPerElement
+        << std::setw(10) << bytesPerNs << std::setw(12) << bytesPerCycle << std::endl;
+    }
+    first = false;
+  }
+  if (options.json) {
+    stream << "\n  ]\n}" << std::endl;
+  }
+
+  return 0;
+}
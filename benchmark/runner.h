@@ -0,0 +1,415 @@
+#pragma once
+
+/**
+ * A small, self-contained benchmark runner that does not require any external dependencies.
+ * The interface is a subset of Google Benchmark, so benchmarks can be compiled with either backend
+ * (see `backend.h`). Every benchmark is warmed up and then measured in several repetitions.
+ * The runner reports the minimum, median and 99th percentile of the time per iteration.
+ * If `EASY_ITERATOR_COUNT_ALLOCATIONS` is defined, the heap allocations and allocated bytes per
+ * iteration of the measured loop are reported as the counters `allocs/iter` and `bytes/iter`.
+ *
+ * Command line options:
+ *   --filter=<substring>   only run benchmarks whose name contains the substring
+ *   --repetitions=<n>      number of measured repetitions (default: 20)
+ *   --min_time=<seconds>   minimum duration of a single repetition (default: 0.01)
+ *   --warmup=<seconds>     warmup duration before measuring (default: 0.05)
+ *   --format=<console|json> output format (default: console)
+ *   --out=<file>           write the output to a file instead of stdout
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef EASY_ITERATOR_COUNT_ALLOCATIONS
+#include <allocation_counter.h>
+#endif
+
+namespace easy_iterator {
+namespace benchmark {
+
+  /**
+   * Prevents the compiler from optimizing away the computation of `value`.
+   */
+  template <class T> inline void DoNotOptimize(T && value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void * sink;
+    sink = &value;
+#endif
+  }
+
+  /**
+   * Forces all pending memory writes to be committed.
+   */
+  inline void ClobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+  }
+
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * The state passed to a benchmark function. The benchmark body is executed for every iteration of
+   * `for (auto _: state)`; only the time spent in this loop is measured.
+   */
+  class State {
+  public:
+    /** Has a non-trivial destructor so that the unused loop variable does not trigger warnings. */
+    struct Value { ~Value(){ } };
+
+    class Iterator {
+      State * state;
+      uint64_t remaining;
+    public:
+      Iterator(State * _state, uint64_t _remaining):state(_state),remaining(_remaining){ }
+      Value operator*()const{ return Value(); }
+      Iterator &operator++(){ --remaining; return *this; }
+      bool operator!=(const Iterator &)const{
+        if (remaining > 0) { return true; }
+        state->finishTiming();
+        return false;
+      }
+    };
+
+    std::map<std::string, double> counters;
+
+    State(uint64_t _iterations, std::vector<int64_t> _arguments):iterations(_iterations),arguments(std::move(_arguments)){ }
+
+    Iterator begin(){ startTiming(); return Iterator(this, iterations); }
+    Iterator end(){ return Iterator(this, 0); }
+
+    int64_t range(size_t idx = 0)const{ return arguments.at(idx); }
+    uint64_t max_iterations()const{ return iterations; }
+
+    void PauseTiming(){ elapsed += Clock::now() - start; running = false; }
+    void ResumeTiming(){ start = Clock::now(); running = true; }
+    void SetItemsProcessed(int64_t items){ itemsProcessed = items; }
+    void SetBytesProcessed(int64_t bytes){ bytesProcessed = bytes; }
+    void SetLabel(const std::string &_label){ label = _label; }
+    void SkipWithError(const char * message){ error = message; }
+
+    double seconds()const{ return std::chrono::duration<double>(elapsed).count(); }
+    int64_t items()const{ return itemsProcessed; }
+    int64_t bytes()const{ return bytesProcessed; }
+    const std::string &getLabel()const{ return label; }
+    const std::string &getError()const{ return error; }
+
+  private:
+    uint64_t iterations;
+    std::vector<int64_t> arguments;
+    Clock::time_point start;
+    Clock::duration elapsed = Clock::duration::zero();
+    bool running = false;
+    int64_t itemsProcessed = 0;
+    int64_t bytesProcessed = 0;
+    std::string label;
+    std::string error;
+
+#ifdef EASY_ITERATOR_COUNT_ALLOCATIONS
+    AllocationCounter allocationCounter;
+
+    void startTiming(){ allocationCounter.reset(); elapsed = Clock::duration::zero(); ResumeTiming(); }
+    void finishTiming(){
+      if (running) { PauseTiming(); }
+      // read both counts before inserting the counters, which allocates itself
+      auto allocations = allocationCounter.allocations(), bytes = allocationCounter.bytes();
+      counters["allocs/iter"] = double(allocations) / iterations;
+      counters["bytes/iter"] = double(bytes) / iterations;
+    }
+#else
+    void startTiming(){ elapsed = Clock::duration::zero(); ResumeTiming(); }
+    void finishTiming(){ if (running) { PauseTiming(); } }
+#endif
+  };
+
+  struct Options {
+    std::string filter;
+    unsigned repetitions = 20;
+    double minTime = 0.01;
+    double warmupTime = 0.05;
+    bool json = false;
+    std::string out;
+  };
+
+  /**
+   * Statistics over all repetitions of a single benchmark.
+   */
+  struct Result {
+    std::string name;
+    std::string label;
+    std::string error;
+    uint64_t iterations = 0;
+    unsigned repetitions = 0;
+    double minNs = 0;
+    double medianNs = 0;
+    double p99Ns = 0;
+    double meanNs = 0;
+    double itemsPerSecond = 0;
+    double bytesPerSecond = 0;
+    std::map<std::string, double> counters;
+  };
+
+  namespace runner_detail {
+    inline double percentile(std::vector<double> sorted, double p){
+      if (sorted.empty()) { return 0; }
+      auto rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+      return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    inline std::string escape(const std::string &value){
+      std::string result;
+      for (auto c: value) {
+        if (c == '"' || c == '\\') { result += '\\'; }
+        result += c;
+      }
+      return result;
+    }
+  }
+
+  /**
+   * Measures `function` with the given arguments and returns the statistics over all repetitions.
+   */
+  inline Result measure(const std::string &name, const std::function<void(State &)> &function, const std::vector<int64_t> &arguments, const Options &options){
+    Result result;
+    result.name = name;
+
+    auto runOnce = [&](uint64_t iterations){
+      State state(iterations, arguments);
+      function(state);
+      return state;
+    };
+
+    // calibrate the number of iterations so that a single repetition takes at least `minTime`
+    uint64_t iterations = 1;
+    while (true) {
+      auto state = runOnce(iterations);
+      if (!state.getError().empty()) {
+        result.error = state.getError();
+        return result;
+      }
+      if (state.seconds() >= options.minTime || iterations >= (uint64_t(1) << 40)) { break; }
+      double factor = state.seconds() > 0 ? 1.4 * options.minTime / state.seconds() : 10;
+      iterations = std::max<uint64_t>(iterations + 1, static_cast<uint64_t>(iterations * std::min(factor, 10.0)));
+    }
+
+    auto warmupEnd = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.warmupTime));
+    while (Clock::now() < warmupEnd) {
+      runOnce(iterations);
+    }
+
+    std::vector<double> times;
+    double items = 0, bytes = 0, seconds = 0;
+    for (unsigned r = 0; r < std::max(1u, options.repetitions); ++r) {
+      auto state = runOnce(iterations);
+      times.push_back(state.seconds() * 1e9 / iterations);
+      seconds += state.seconds();
+      items += state.items();
+      bytes += state.bytes();
+      result.label = state.getLabel();
+      for (auto &counter: state.counters) {
+        result.counters[counter.first] += counter.second;
+      }
+    }
+
+    double total = 0;
+    for (auto t: times) { total += t; }
+    result.repetitions = static_cast<unsigned>(times.size());
+    for (auto &counter: result.counters) {
+      counter.second /= times.size();
+    }
+    std::sort(times.begin(), times.end());
+    result.iterations = iterations;
+    result.minNs = times.front();
+    result.medianNs = runner_detail::percentile(times, 0.5);
+    result.p99Ns = runner_detail::percentile(times, 0.99);
+    result.meanNs = total / times.size();
+    if (seconds > 0) {
+      result.itemsPerSecond = items / seconds;
+      result.bytesPerSecond = bytes / seconds;
+    }
+    return result;
+  }
+
+  /**
+   * A registered benchmark. The configuration methods mirror the Google Benchmark API.
+   */
+  class Benchmark {
+  public:
+    Benchmark(std::string _name, std::function<void(State &)> _function):name(std::move(_name)),function(std::move(_function)){ }
+
+    Benchmark * Arg(int64_t value){ arguments.push_back({value}); return this; }
+    Benchmark * Args(std::vector<int64_t> values){ arguments.push_back(std::move(values)); return this; }
+    Benchmark * RangeMultiplier(int64_t value){
+      assert(value > 1);
+      multiplier = std::max<int64_t>(value, 2);
+      return this;
+    }
+    /** Adds `begin`, the powers of the multiplier in between and `end`. As in Google Benchmark, 0 is followed by 1. */
+    Benchmark * Range(int64_t begin, int64_t end){
+      assert(begin >= 0 && begin <= end);
+      if (begin <= 0 && end > 0) { Arg(0); begin = 1; }
+      for (auto v = begin; v < end; v *= multiplier) { Arg(v); }
+      return Arg(end);
+    }
+
+    std::string name;
+    std::function<void(State &)> function;
+    std::vector<std::vector<int64_t>> arguments;
+    int64_t multiplier = 8;
+  };
+
+  inline std::vector<std::unique_ptr<Benchmark>> &registry(){
+    static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+    return benchmarks;
+  }
+
+  inline Benchmark * RegisterBenchmark(const std::string &name, std::function<void(State &)> function){
+    registry().emplace_back(std::make_unique<Benchmark>(name, std::move(function)));
+    return registry().back().get();
+  }
+
+  inline void printConsole(std::ostream &stream, const std::vector<Result> &results){
+    stream << std::left << std::setw(40) << "Benchmark" << std::right
+      << std::setw(14) << "min [ns]" << std::setw(14) << "median [ns]" << std::setw(14) << "p99 [ns]"
+      << std::setw(14) << "iterations" << std::endl;
+    stream << std::string(96, '-') << std::endl;
+    for (auto &result: results) {
+      stream << std::left << std::setw(40) << result.name << std::right;
+      if (!result.error.empty()) {
+        stream << "  ERROR: " << result.error << std::endl;
+        continue;
+      }
+      stream << std::fixed << std::setprecision(2)
+        << std::setw(14) << result.minNs << std::setw(14) << result.medianNs << std::setw(14) << result.p99Ns
+        << std::setw(14) << result.iterations;
+      if (result.itemsPerSecond > 0) { stream << "  items/s=" << result.itemsPerSecond; }
+      if (result.bytesPerSecond > 0) { stream << "  bytes/s=" << result.bytesPerSecond; }
+      for (auto &counter: result.counters) { stream << "  " << counter.first << "=" << counter.second; }
+      if (!result.label.empty()) { stream << "  " << result.label; }
+      stream << std::endl;
+    }
+  }
+
+  inline void printJson(std::ostream &stream, const std::vector<Result> &results){
+    using runner_detail::escape;
+    stream << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+      auto &result = results[i];
+      stream << (i ? "," : "") << "\n    {\n";
+      stream << "      \"name\": \"" << escape(result.name) << "\",\n";
+      if (!result.error.empty()) {
+        stream << "      \"error\": \"" << escape(result.error) << "\"\n    }";
+        continue;
+      }
+      stream << std::setprecision(17);
+      stream << "      \"iterations\": " << result.iterations << ",\n";
+      stream << "      \"repetitions\": " << result.repetitions << ",\n";
+      stream << "      \"min_ns\": " << result.minNs << ",\n";
+      stream << "      \"median_ns\": " << result.medianNs << ",\n";
+      stream << "      \"p99_ns\": " << result.p99Ns << ",\n";
+      stream << "      \"mean_ns\": " << result.meanNs << ",\n";
+      stream << "      \"items_per_second\": " << result.itemsPerSecond << ",\n";
+      stream << "      \"bytes_per_second\": " << result.bytesPerSecond << ",\n";
+      stream << "      \"label\": \"" << escape(result.label) << "\",\n";
+      stream << "      \"counters\": {";
+      size_t c = 0;
+      for (auto &counter: result.counters) {
+        stream << (c++ ? ", " : "") << "\"" << escape(counter.first) << "\": " << counter.second;
+      }
+      stream << "}\n    }";
+    }
+    stream << "\n  ]\n}" << std::endl;
+  }
+
+  inline Options parseOptions(int argc, char ** argv){
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      auto value = [&](const std::string &key) -> const char * {
+        return arg.rfind(key, 0) == 0 ? arg.c_str() + key.size() : nullptr;
+      };
+      if (auto v = value("--filter=")) { options.filter = v; }
+      else if (auto v = value("--repetitions=")) { options.repetitions = static_cast<unsigned>(std::stoul(v)); }
+      else if (auto v = value("--min_time=")) { options.minTime = std::stod(v); }
+      else if (auto v = value("--warmup=")) { options.warmupTime = std::stod(v); }
+      else if (auto v = value("--format=")) { options.json = std::string(v) == "json"; }
+      else if (auto v = value("--out=")) { options.out = v; }
+      else { std::cerr << "ignoring unknown option " << arg << std::endl; }
+    }
+    return options;
+  }
+
+  inline std::string benchmarkName(const Benchmark &benchmark, const std::vector<int64_t> &arguments){
+    std::string name = benchmark.name;
+    for (auto a: arguments) { name += "/" + std::to_string(a); }
+    return name;
+  }
+
+  /**
+   * Runs all registered benchmarks and prints the results.
+   */
+  inline int runAll(const Options &options){
+    std::vector<Result> results;
+    for (auto &benchmark: registry()) {
+      auto argumentSets = benchmark->arguments.empty() ? std::vector<std::vector<int64_t>>{{}} : benchmark->arguments;
+      for (auto &arguments: argumentSets) {
+        auto name = benchmarkName(*benchmark, arguments);
+        if (name.find(options.filter) == std::string::npos) { continue; }
+        results.push_back(measure(name, benchmark->function, arguments, options));
+        if (!options.json && options.out.empty()) {
+          std::cerr << "finished " << name << std::endl;
+        }
+      }
+    }
+    std::ofstream file;
+    if (!options.out.empty()) { file.open(options.out); }
+    std::ostream &stream = options.out.empty() ? std::cout : file;
+    if (options.json) {
+      printJson(stream, results);
+    } else {
+      printConsole(stream, results);
+    }
+    for (auto &result: results) {
+      if (!result.error.empty()) { return 1; }
+    }
+    return 0;
+  }
+
+}
+}
+
+#define EASY_ITERATOR_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define EASY_ITERATOR_BENCHMARK_CONCAT(a, b) EASY_ITERATOR_BENCHMARK_CONCAT_IMPL(a, b)
+
+/**
+ * Registers a benchmark function `void f(easy_iterator::benchmark::State &)`.
+ */
+#define EASY_ITERATOR_BENCHMARK(function) \
+  static auto * EASY_ITERATOR_BENCHMARK_CONCAT(easy_iterator_benchmark_, __LINE__) = \
+    ::easy_iterator::benchmark::RegisterBenchmark(#function, function)
+
+/**
+ * Defines a `main` function that runs all registered benchmarks.
+ */
+#define EASY_ITERATOR_BENCHMARK_MAIN() \
+  int main(int argc, char ** argv) { \
+    return ::easy_iterator::benchmark::runAll(::easy_iterator::benchmark::parseOptions(argc, argv)); \
+  }
@@ -0,0 +1,296 @@
+/**
+ * Measures how data-parallel loops written with EasyIterator scale with the number of threads.
+ * Every kernel (transform, reduce, scan and filter) splits the input into one contiguous chunk per
+ * thread and iterates each chunk with EasyIterator. The same kernels are run with raw pointer loops
+ * on `std::thread`, and with OpenMP if it is available, as baselines.
+ * For 1, 2, 4 ... N threads the speedup, parallel efficiency and per-thread throughput are reported.
+ * The speedup is relative to the single-threaded run of the same kernel, which is measured even
+ * if `--filter` excludes it.
+ *
+ * Additional command line options (all runner options are also accepted, repetitions default to 5):
+ *   --size=<n>       number of elements (default: 16777216)
+ *   --threads=<n>    maximum number of threads (default: hardware concurrency)
+ *   --trace=<file>   write a Chrome trace of every chunk to `file`
+ */
+
+#include "runner.h"
+#include <easy_iterator.h>
+#include <easy_iterator/trace.h>
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef EASY_ITERATOR_HAS_OPENMP
+#include <omp.h>
+#endif
+
+using namespace easy_iterator;
+using benchmark::DoNotOptimize;
+
+using Value = double;
+
+/**
+ * Calls `f(thread, begin, end)` for one contiguous chunk of `[0, n)` per thread.
+ */
+template <class F> void parallelChunks(unsigned threads, size_t n, F && f){
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (auto t: range(threads)) {
+    size_t begin = n * t / threads, end = n * (t + 1) / threads;
+    workers.emplace_back([&f, t, begin, end](){
+      trace::Span span("chunk");
+      f(t, begin, end);
+    });
+  }
+  for (auto &worker: workers) { worker.join(); }
+}
+
+struct Data {
+  std::vector<Value> input, output;
+  explicit Data(size_t n):input(n),output(n){
+    copy(range(n), input, [](size_t i){ return Value(i % 1000) - 500; });
+  }
+};
+
+// ---- EasyIterator kernels ----
+
+void easyTransform(Data &data, unsigned threads){
+  parallelChunks(threads, data.input.size(), [&](unsigned, size_t begin, size_t end){
+    auto in = data.input.data(), out = data.output.data();
+    for (auto [x, y]: zip(valuesBetween(in + begin, in + end), valuesBetween(out + begin, out + end))) {
+      y = 2 * x + 1;
+    }
+  });
+}
+
+Value easyReduce(Data &data, unsigned threads){
+  std::vector<Value> partial(threads);
+  parallelChunks(threads, data.input.size(), [&](unsigned t, size_t begin, size_t end){
+    Value sum = 0;
+    for (auto &v: valuesBetween(data.input.data() + begin, data.input.data() + end)) { sum += v; }
+    partial[t] = sum;
+  });
+  Value sum = 0;
+  for (auto v: partial) { sum += v; }
+  return sum;
+}
+
+void easyScan(Data &data, unsigned threads){
+  std::vector<Value> offsets(threads + 1);
+  auto in = data.input.data(), out = data.output.data();
+  parallelChunks(threads, data.input.size(), [&](unsigned t, size_t begin, size_t end){
+    Value sum = 0;
+    for (auto [x, y]: zip(valuesBetween(in + begin, in + end), valuesBetween(out + begin, out + end))) {
+      sum += x;
+      y = sum;
+    }
+    offsets[t + 1] = sum;
+  });
+  for (auto t: range(threads)) { offsets[t + 1] += offsets[t]; }
+  parallelChunks(threads, data.input.size(), [&](unsigned t, size_t begin, size_t end){
+    for (auto &y: valuesBetween(out + begin, out + end)) { y += offsets[t]; }
+  });
+}
+
+size_t easyFilter(Data &data, unsigned threads){
+  std::vector<size_t> counts(threads);
+  auto in = data.input.data(), out = data.output.data();
+  parallelChunks(threads, data.input.size(), [&](unsigned t, size_t begin, size_t end){
+    auto target = out + begin;
+    for (auto &v: valuesBetween(in + begin, in + end)) {
+      *target = v;
+      target += v > 0;
+    }
+    counts[t] = target - (out + begin);
+  });
+  size_t total = 0;
+  for (auto c: counts) { total += c; }
+  return total;
+}
+
+// ---- raw std::thread kernels ----
+
+void rawTransform(Data &data, unsigned threads){
+  parallelChunks(threads, data.input.size(), [&](unsigned, size_t begin, size_t end){
+    auto in = data.input.data(), out = data.output.data();
+    for (size_t i = begin; i < end; ++i) { out[i] = 2 * in[i] + 1; }
+  });
+}
+
+Value rawReduce(Data &data, unsigned threads){
+  std::vector<Value> partial(threads);
+  parallelChunks(threads, data.input.size(), [&](unsigned t, size_t begin, size_t end){
+    Value sum = 0;
+    auto in = data.input.data();
+    for (size_t i = begin; i < end; ++i) { sum += in[i]; }
+    partial[t] = sum;
+  });
+  Value sum = 0;
+  for (auto v: partial) { sum += v; }
+  return sum;
+}
+
+void rawScan(Data &data, unsigned threads){
+  std::vector<Value> offsets(threads + 1);
+  auto in = data.input.data(), out = data.output.data();
+  parallelChunks(threads, data.input.size(), [&](unsigned t, size_t begin, size_t end){
+    Value sum = 0;
+    for (size_t i = begin; i < end; ++i) { sum += in[i]; out[i] = sum; }
+    offsets[t + 1] = sum;
+  });
+  for (unsigned t = 0; t < threads; ++t) { offsets[t + 1] += offsets[t]; }
+  parallelChunks(threads, data.input.size(), [&](unsigned t, size_t begin, size_t end){
+    for (size_t i = begin; i < end; ++i) { out[i] += offsets[t]; }
+  });
+}
+
+size_t rawFilter(Data &data, unsigned threads){
+  std::vector<size_t> counts(threads);
+  auto in = data.input.data(), out = data.output.data();
+  parallelChunks(threads, data.input.size(), [&](unsigned t, size_t begin, size_t end){
+    auto target = out + begin;
+    for (size_t i = begin; i < end; ++i) { *target = in[i]; target += in[i] > 0; }
+    counts[t] = target - (out + begin);
+  });
+  size_t total = 0;
+  for (auto c: counts) { total += c; }
+  return total;
+}
+
+// ---- OpenMP kernels ----
+
+#ifdef EASY_ITERATOR_HAS_OPENMP
+
+void ompTransform(Data &data, unsigned threads){
+  auto in = data.input.data(), out = data.output.data();
+  long n = static_cast<long>(data.input.size());
+  #pragma omp parallel for num_threads(threads) schedule(static)
+  for (long i = 0; i < n; ++i) { out[i] = 2 * in[i] + 1; }
+}
+
+Value ompReduce(Data &data, unsigned threads){
+  auto in = data.input.data();
+  long n = static_cast<long>(data.input.size());
+  Value sum = 0;
+  #pragma omp parallel for num_threads(threads) schedule(static) reduction(+:sum)
+  for (long i = 0; i < n; ++i) { sum += in[i]; }
+  return sum;
+}
+
+#endif
+
+// ---- report ----
+
+struct Kernel {
+  std::string primitive;
+  std::string variant;
+  std::function<void(Data &, unsigned)> run;
+};
+
+std::vector<Kernel> makeKernels(){
+  std::vector<Kernel> kernels{
+    {"transform", "easy", [](Data &d, unsigned t){ easyTransform(d, t); }},
+    {"transform", "thread", [](Data &d, unsigned t){ rawTransform(d, t); }},
+    {"reduce", "easy", [](Data &d, unsigned t){ DoNotOptimize(easyReduce(d, t)); }},
+    {"reduce", "thread", [](Data &d, unsigned t){ DoNotOptimize(rawReduce(d, t)); }},
+    {"scan", "easy", [](Data &d, unsigned t){ easyScan(d, t); }},
+    {"scan", "thread", [](Data &d, unsigned t){ rawScan(d, t); }},
+    {"filter", "easy", [](Data &d, unsigned t){ DoNotOptimize(easyFilter(d, t)); }},
+    {"filter", "thread", [](Data &d, unsigned t){ DoNotOptimize(rawFilter(d, t)); }},
+  };
+#ifdef EASY_ITERATOR_HAS_OPENMP
+  kernels.push_back({"transform", "openmp", [](Data &d, unsigned t){ ompTransform(d, t); }});
+  kernels.push_back({"reduce", "openmp", [](Data &d, unsigned t){ DoNotOptimize(ompReduce(d, t)); }});
+#endif
+  return kernels;
+}
+
+int main(int argc, char ** argv){
+  size_t size = size_t(1) << 24;
+  unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  std::string tracePath;
+  bool repetitionsSet = false;
+  std::vector<char *> runnerArguments{argv[0]};
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("--size=", 0) == 0) { size = std::stoull(arg.substr(7)); }
+    else if (arg.rfind("--threads=", 0) == 0) { maxThreads = static_cast<unsigned>(std::stoul(arg.substr(10))); }
+    else if (arg.rfind("--trace=", 0) == 0) { tracePath = arg.substr(8); }
+    else {
+      repetitionsSet |= arg.rfind("--repetitions=", 0) == 0;
+      runnerArguments.push_back(argv[i]);
+    }
+  }
+  auto options = benchmark::parseOptions(static_cast<int>(runnerArguments.size()), runnerArguments.data());
+  if (!repetitionsSet) { options.repetitions = 5; }
+
+  std::vector<unsigned> threadCounts;
+  for (unsigned t = 1; t < maxThreads; t *= 2) { threadCounts.push_back(t); }
+  threadCounts.push_back(maxThreads);
+
+  Data data(size);
+
+  if (!tracePath.empty() && !trace::Tracer::global().start(tracePath)) {
+    std::cerr << "cannot open trace file " << tracePath << std::endl;
+    return 1;
+  }
+
+  std::ofstream file;
+  if (!options.out.empty()) { file.open(options.out); }
+  std::ostream &stream = options.out.empty() ? std::cout : file;
+
+  if (options.json) {
+    stream << "{\n  \"elements\": " << size << ",\n  \"results\": [";
+  } else {
+    stream << std::left << std::setw(12) << "primitive" << std::setw(8) << "variant" << std::right << std::setw(8) << "threads"
+      << std::setw(14) << "median [ms]" << std::setw(10) << "speedup" << std::setw(12) << "efficiency"
+      << std::setw(20) << "Melements/s/thread" << std::endl;
+  }
+
+  bool first = true;
+  for (auto &kernel: makeKernels()) {
+    auto nameFor = [&](unsigned threads){ return kernel.primitive + "/" + kernel.variant + "/" + std::to_string(threads); };
+    auto measureSeconds = [&](unsigned threads){
+      auto result = benchmark::measure(nameFor(threads), [&](benchmark::State &state){
+        for (auto _: state) {
+          kernel.run(data, threads);
+          benchmark::ClobberMemory();
+        }
+      }, {}, options);
+      return result.medianNs * 1e-9;
+    };
+    // the speedup is always relative to a measured single-threaded run, even if it is filtered out
+    double singleThreaded = 0;
+    for (auto threads: threadCounts) {
+      if (nameFor(threads).find(options.filter) == std::string::npos) { continue; }
+      if (singleThreaded == 0) { singleThreaded = measureSeconds(1); }
+      double seconds = threads == 1 ? singleThreaded : measureSeconds(threads);
+      double speedup = singleThreaded / seconds;
+      double efficiency = speedup / threads;
+      double perThread = size / seconds / threads * 1e-6;
+
+      stream << std::fixed << std::setprecision(3);
+      if (options.json) {
+        stream << (first ? "" : ",") << "\n    {\"primitive\": \"" << kernel.primitive << "\", \"variant\": \"" << kernel.variant
+          << "\", \"threads\": " << threads << ", \"median_ms\": " << seconds * 1e3 << ", \"speedup\": " << speedup
+          << ", \"efficiency\": " << efficiency << ", \"melements_per_second_per_thread\": " << perThread << "}";
+      } else {
+        stream << std::left << std::setw(12) << kernel.primitive << std::setw(8) << kernel.variant << std::right << std::setw(8) << threads
+          << std::setw(14) << seconds * 1e3 << std::setw(10) << speedup << std::setw(12) << efficiency
+          << std::setw(20) << perThread << std::endl;
+      }
+      first = false;
+    }
+  }
+  if (options.json) {
+    stream << "\n  ]\n}" << std::endl;
+  }
+  trace::Tracer::global().stop();
+
+  return 0;
+}
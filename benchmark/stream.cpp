@@ -0,0 +1,170 @@
+/**
+ * STREAM-style memory bandwidth benchmark. The copy, scale, add and triad kernels are written with
+ * `copy` and `zip` and measured next to raw pointer versions. By default every array is measured
+ * at a cache-resident size, at half of the last level cache and at four times the last level cache.
+ * Bandwidth is reported in GB/s, counting bytes like STREAM, and as a fraction of the highest
+ * bandwidth measured on this machine by any raw kernel or `memcpy` at the same array size.
+ *
+ * Additional command line options (all runner options are also accepted, repetitions default to 5):
+ *   --size=<n>    only measure arrays with `n` elements
+ */
+
+#include "runner.h"
+#include <easy_iterator.h>
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifdef __unix__
+#include <unistd.h>
+#endif
+
+using namespace easy_iterator;
+
+using Value = double;
+constexpr Value scalar = 3;
+
+struct Arrays {
+  std::vector<Value> a, b, c;
+  explicit Arrays(size_t n):a(n, 1),b(n, 2),c(n, 0){ }
+};
+
+// ---- EasyIterator kernels ----
+
+void __attribute__((noinline)) easyCopy(Arrays &x){ easy_iterator::copy(x.a, x.c); }
+void __attribute__((noinline)) easyScale(Arrays &x){ easy_iterator::copy(x.c, x.b, [](Value v){ return scalar * v; }); }
+void __attribute__((noinline)) easyAdd(Arrays &x){ for (auto [a, b, c]: zip(x.a, x.b, x.c)) { c = a + b; } }
+void __attribute__((noinline)) easyTriad(Arrays &x){ for (auto [a, b, c]: zip(x.a, x.b, x.c)) { a = b + scalar * c; } }
+
+// ---- raw pointer kernels ----
+
+void __attribute__((noinline)) rawCopy(Arrays &x){
+  auto a = x.a.data(), c = x.c.data();
+  for (size_t i = 0, n = x.a.size(); i < n; ++i) { c[i] = a[i]; }
+}
+
+void __attribute__((noinline)) rawScale(Arrays &x){
+  auto b = x.b.data(), c = x.c.data();
+  for (size_t i = 0, n = x.a.size(); i < n; ++i) { b[i] = scalar * c[i]; }
+}
+
+void __attribute__((noinline)) rawAdd(Arrays &x){
+  auto a = x.a.data(), b = x.b.data(), c = x.c.data();
+  for (size_t i = 0, n = x.a.size(); i < n; ++i) { c[i] = a[i] + b[i]; }
+}
+
+void __attribute__((noinline)) rawTriad(Arrays &x){
+  auto a = x.a.data(), b = x.b.data(), c = x.c.data();
+  for (size_t i = 0, n = x.a.size(); i < n; ++i) { a[i] = b[i] + scalar * c[i]; }
+}
+
+void __attribute__((noinline)) memcpyCopy(Arrays &x){
+  std::memcpy(x.c.data(), x.a.data(), x.a.size() * sizeof(Value));
+}
+
+struct Kernel {
+  std::string name;
+  std::string variant;
+  unsigned arrays;
+  void (*run)(Arrays &);
+};
+
+size_t lastLevelCacheBytes(){
+#if defined(__unix__) && defined(_SC_LEVEL3_CACHE_SIZE)
+  auto l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+  if (l3 > 0) { return static_cast<size_t>(l3); }
+  auto l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+  if (l2 > 0) { return static_cast<size_t>(l2); }
+#endif
+  return size_t(32) << 20;
+}
+
+int main(int argc, char ** argv){
+  std::vector<size_t> sizes;
+  bool repetitionsSet = false;
+  std::vector<char *> runnerArguments{argv[0]};
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("--size=", 0) == 0) { sizes.push_back(std::stoull(arg.substr(7))); }
+    else {
+      repetitionsSet |= arg.rfind("--repetitions=", 0) == 0;
+      runnerArguments.push_back(argv[i]);
+    }
+  }
+  auto options = benchmark::parseOptions(static_cast<int>(runnerArguments.size()), runnerArguments.data());
+  if (!repetitionsSet) { options.repetitions = 5; }
+
+  auto llc = lastLevelCacheBytes();
+  if (sizes.empty()) {
+    sizes = {size_t(1) << 11, llc / 2 / sizeof(Value), 4 * llc / sizeof(Value)};
+  }
+
+  std::vector<Kernel> kernels{
+    {"copy", "easy", 2, easyCopy}, {"copy", "raw", 2, rawCopy}, {"copy", "memcpy", 2, memcpyCopy},
+    {"scale", "easy", 2, easyScale}, {"scale", "raw", 2, rawScale},
+    {"add", "easy", 3, easyAdd}, {"add", "raw", 3, rawAdd},
+    {"triad", "easy", 3, easyTriad}, {"triad", "raw", 3, rawTriad},
+  };
+
+  struct Row { std::string name; std::string variant; size_t size; double gbPerSecond; };
+  std::vector<Row> rows;
+  std::map<size_t, double> peak;
+
+  for (auto size: sizes) {
+    Arrays arrays(size);
+    for (auto &kernel: kernels) {
+      auto name = kernel.name + "/" + kernel.variant + "/" + std::to_string(size);
+      if (name.find(options.filter) == std::string::npos) { continue; }
+      auto result = benchmark::measure(name, [&](benchmark::State &state){
+        for (auto _: state) {
+          kernel.run(arrays);
+          benchmark::ClobberMemory();
+        }
+      }, {}, options);
+      // STREAM counts best-case times
+      double gbPerSecond = kernel.arrays * sizeof(Value) * size / result.minNs;
+      rows.push_back({kernel.name, kernel.variant, size, gbPerSecond});
+      if (kernel.variant != "easy") { peak[size] = std::max(peak[size], gbPerSecond); }
+    }
+  }
+
+  // the peak comes from the plain kernels, which may all be filtered out
+  auto peakFraction = [&](const Row &row){
+    auto it = peak.find(row.size);
+    return it != peak.end() && it->second > 0 ? std::optional<double>(row.gbPerSecond / it->second) : std::nullopt;
+  };
+
+  std::ofstream file;
+  if (!options.out.empty()) { file.open(options.out); }
+  std::ostream &stream = options.out.empty() ? std::cout : file;
+
+  stream << std::fixed << std::setprecision(3);
+  if (options.json) {
+    stream << "{\n  \"last_level_cache_bytes\": " << llc << ",\n  \"results\": [";
+    for (size_t i = 0; i < rows.size(); ++i) {
+      auto &row = rows[i];
+      stream << (i ? "," : "") << "\n    {\"kernel\": \"" << row.name << "\", \"variant\": \"" << row.variant
+        << "\", \"elements\": " << row.size << ", \"bytes_per_array\": " << row.size * sizeof(Value)
+        << ", \"gb_per_second\": " << row.gbPerSecond << ", \"fraction_of_peak\": ";
+      if (auto fraction = peakFraction(row)) { stream << *fraction; } else { stream << "null"; }
+      stream << "}";
+    }
+    stream << "\n  ]\n}" << std::endl;
+  } else {
+    stream << "last level cache: " << llc / 1024 << " KiB" << std::endl;
+    stream << std::left << std::setw(8) << "kernel" << std::setw(8) << "variant" << std::right << std::setw(14) << "array [KiB]"
+      << std::setw(10) << "GB/s" << std::setw(10) << "of peak" << std::endl;
+    for (auto &row: rows) {
+      stream << std::left << std::setw(8) << row.name << std::setw(8) << row.variant << std::right
+        << std::setw(14) << row.size * sizeof(Value) / 1024 << std::setw(10) << row.gbPerSecond << std::setw(10);
+      if (auto fraction = peakFraction(row)) { stream << *fraction; } else { stream << "-"; }
+      stream << std::endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "iterator.h"
+#include "zip.h"
+
+namespace easy_iterator {
+
+  /**
+   * copy-assigns the given value to every element in a container
+   */
+  template <class T, class A> void fill(A &arr, const T & value){
+    for (auto &v: arr) {
+      v = value;
+    }
+  }
+  
+  /**
+   * copies values from one container to another.
+   * @param `a` - the container with values to be copies.
+   * @param `b` - the target container.
+   * @param `f` (optional) - a function to transform values before copying.
+   * Behaviour is undefined if `a` and `b` do not have the same size.
+   */
+  template <class A, class B, class T = dereference::ByValueReference> void copy(const A &a, B &b, T && t = T()){
+    for (auto [v1,v2]: zip(a,b)) { v2 = t(v1); }
+  }
+
+  /**
+   * Returns a pointer to the value if found, otherwise `nullptr`.
+   * Usage: `if(auto v = found(map.find(key),map)){ do_something(v); }`
+   */
+  template <class I, class C> decltype(&*std::declval<I>()) found(const I &it, C &container){
+    if (it != container.end()) { 
+      return &*it;
+    } else {
+      return nullptr;
+    }
+  }  
+
+  /**
+   * Removes a value from a container with `find` method.
+   * Usage: `eraseIfFound(map.find(key),map);`
+   */
+  template <class I, class C> bool eraseIfFound(const I &it, C &container){
+    if (it != container.end()) { 
+      container.erase(it);
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+}
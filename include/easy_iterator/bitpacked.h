@@ -0,0 +1,356 @@
+#pragma once
+
+/**
+ * Random-access iterables over fixed-width integers packed into 64 bit words. Value `i` occupies
+ * bits `[i * bits, (i + 1) * bits)` of the word array, so every block of 64 values fills exactly
+ * `bits` words. `scan()` and `unpack()` decode whole blocks with unpack code generated for every
+ * width: AVX2 shuffles and shifts for up to 25 bits if available, straight-line scalar code otherwise.
+ * Usage:
+ *   auto packed = pack_bits<12>(codes);
+ *   auto view = bitpacked<12>(packed.words, packed.size);
+ *   auto code = view[42];
+ *   for (auto code: view.scan()) { ... }
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(EASY_ITERATOR_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define EASY_ITERATOR_AVX2 1
+#endif
+
+#include "compression.h"
+#include "iterator.h"
+
+namespace easy_iterator {
+
+  /**
+   * The words of packed integers as written by `pack_bits()`.
+   */
+  struct PackedBits {
+    std::vector<uint64_t> words;
+    size_t size = 0;
+    unsigned bits = 0;
+  };
+
+  namespace bitpacked_detail {
+
+    constexpr size_t blockSize = compression_detail::blockSize;
+    static_assert(blockSize == 64, "a block of packed values must fill whole words");
+
+    constexpr uint64_t mask(unsigned bits) { return bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1; }
+
+    inline uint64_t extract(const uint64_t * words, size_t index, unsigned bits) {
+      size_t bit = index * bits;
+      size_t word = bit / 64;
+      unsigned offset = bit % 64;
+      uint64_t value = words[word] >> offset;
+      if (offset + bits > 64) { value |= words[word + 1] << (64 - offset); }
+      return value & mask(bits);
+    }
+
+    template <unsigned Bits, class T, size_t ... Idx> void unpackBlock(const uint64_t * words, T * out, std::index_sequence<Idx...>) {
+      // all word indices and shifts are constants, so this compiles to straight-line code
+      ((out[Idx] = static_cast<T>((
+        (words[Idx * Bits / 64] >> (Idx * Bits % 64))
+        | ((Idx * Bits % 64) + Bits > 64 ? words[Idx * Bits / 64 + 1] << ((64 - Idx * Bits % 64) % 64) : 0)
+      ) & mask(Bits))), ...);
+    }
+
+#ifdef EASY_ITERATOR_AVX2
+    /**
+     * Every group of eight values starts at a byte boundary. Each half of a group is loaded into one
+     * 128 bit lane, its bytes are shuffled into the 32 bit lanes of the values and shifted into place.
+     * Loads near the end of the block are moved back so that they never read past it.
+     */
+    template <unsigned Bits> struct SimdPattern {
+      static constexpr unsigned highByte = 4 * Bits / 8;
+      static constexpr unsigned blockBytes = 8 * Bits;
+      uint8_t shuffle[8][32] = {};
+      uint32_t shifts[8] = {};
+      unsigned loads[8][2] = {};
+      bool usable[8] = {};
+
+      constexpr SimdPattern() {
+        for (unsigned group = 0; group < 8; ++group) {
+          usable[group] = blockBytes >= 16;
+          for (unsigned half = 0; half < 2; ++half) {
+            unsigned start = group * Bits + half * highByte;
+            loads[group][half] = blockBytes >= 16 && start + 16 > blockBytes ? blockBytes - 16 : start;
+            for (unsigned j = 4 * half; j < 4 * half + 4; ++j) {
+              unsigned bit = j * Bits - 8 * half * highByte;
+              for (unsigned byte = 0; byte < 4; ++byte) {
+                // bytes beyond the value are zeroed, they might be past the end of the block
+                unsigned index = bit / 8 + byte + start - loads[group][half];
+                bool needed = 8 * byte < bit % 8 + Bits;
+                if (needed && index >= 16) { usable[group] = false; }
+                shuffle[group][4 * j + byte] = needed ? static_cast<uint8_t>(index) : 0x80;
+              }
+              shifts[j] = bit % 8;
+            }
+          }
+        }
+      }
+    };
+
+    template <unsigned Bits> constexpr SimdPattern<Bits> simdPattern{};
+
+    template <unsigned Bits, unsigned Group, class T> void unpackGroup(const uint8_t * bytes, T * out, __m256i shifts, __m256i valueMask) {
+      constexpr auto &pattern = simdPattern<Bits>;
+      out += 8 * Group;
+      if constexpr (!pattern.usable[Group]) {
+        for (unsigned j = 0; j < 8; ++j) { out[j] = static_cast<T>(extract(reinterpret_cast<const uint64_t *>(bytes), 8 * Group + j, Bits)); }
+      } else {
+        __m256i x = _mm256_inserti128_si256(
+          _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + pattern.loads[Group][0]))),
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + pattern.loads[Group][1])), 1
+        );
+        const __m256i shuffle = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pattern.shuffle[Group]));
+        x = _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(x, shuffle), shifts), valueMask);
+        if constexpr (sizeof(T) == 4) {
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), x);
+        } else {
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_cvtepu32_epi64(_mm256_castsi256_si128(x)));
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 4), _mm256_cvtepu32_epi64(_mm256_extracti128_si256(x, 1)));
+        }
+      }
+    }
+
+    template <unsigned Bits, class T, unsigned ... Groups> void unpackSimd(const uint64_t * words, T * out, std::integer_sequence<unsigned, Groups...>) {
+      const __m256i shifts = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(simdPattern<Bits>.shifts));
+      const __m256i valueMask = _mm256_set1_epi32(static_cast<int>(mask(Bits)));
+      (unpackGroup<Bits, Groups>(reinterpret_cast<const uint8_t *>(words), out, shifts, valueMask), ...);
+    }
+
+    template <unsigned Bits, class T> void unpackSimd(const uint64_t * words, T * out) {
+      unpackSimd<Bits>(words, out, std::make_integer_sequence<unsigned, 8>());
+    }
+#endif
+
+    /**
+     * Unpacks the 64 values stored in `words[0, Bits)`.
+     */
+    template <unsigned Bits, class T> void unpackBlock(const uint64_t * words, T * out) {
+#ifdef EASY_ITERATOR_AVX2
+      // a value and its bit offset fit into the 32 bits gathered for every lane
+      if constexpr (Bits <= 25 && (sizeof(T) == 4 || sizeof(T) == 8)) {
+        unpackSimd<Bits>(words, out);
+        return;
+      }
+#endif
+      unpackBlock<Bits>(words, out, std::make_index_sequence<blockSize>());
+    }
+
+    template <class T> using Unpacker = void (*)(const uint64_t *, T *);
+
+    template <class T, size_t ... Bits> constexpr std::array<Unpacker<T>, sizeof...(Bits)> makeUnpackers(std::index_sequence<Bits...>) {
+      return {{&unpackBlock<static_cast<unsigned>(Bits + 1), T>...}};
+    }
+
+    /**
+     * The block unpacker for `bits` in [1, 64].
+     */
+    template <class T> Unpacker<T> unpacker(unsigned bits) {
+      static constexpr auto unpackers = makeUnpackers<T>(std::make_index_sequence<64>());
+      return unpackers[bits - 1];
+    }
+
+    /**
+     * Width of a packed view, either a compile-time constant or stored at runtime.
+     */
+    template <unsigned Bits> struct Width {
+      static constexpr unsigned bits() { return Bits; }
+      template <class T> static constexpr Unpacker<T> unpacker() { return &unpackBlock<Bits, T>; }
+    };
+
+    template <> struct Width<0> {
+      unsigned value;
+      unsigned bits() const { return value; }
+      template <class T> Unpacker<T> unpacker() const { return bitpacked_detail::unpacker<T>(value); }
+    };
+
+    inline void checkBits(unsigned bits) {
+      if (bits == 0 || bits > 64) { throw std::invalid_argument("bit width must be between 1 and 64"); }
+    }
+
+    template <unsigned Bits> using ValueType = std::conditional_t<Bits != 0 && Bits <= 32, uint32_t, uint64_t>;
+
+    /**
+     * Decodes consecutive blocks for `BitPacked::scan()`.
+     */
+    template <unsigned Bits> class UnpackSource {
+      const uint64_t * words;
+      size_t index;
+      size_t size;
+      Width<Bits> width;
+    public:
+      using value_type = ValueType<Bits>;
+      UnpackSource(const uint64_t * _words, size_t _index, size_t _size, Width<Bits> _width):words(_words),index(_index),size(_size),width(_width){ }
+      size_t decode(value_type * out, size_t max) {
+        size_t count = std::min(max, size - index);
+        if (count == blockSize && index % blockSize == 0) {
+          width.template unpacker<value_type>()(words + index / 64 * width.bits(), out);
+        } else {
+          for (size_t i = 0; i < count; ++i) { out[i] = static_cast<value_type>(extract(words, index + i, width.bits())); }
+        }
+        index += count;
+        return count;
+      }
+    };
+
+  }
+
+  /**
+   * A random-access view of `size` integers of `Bits` bits each, or of a runtime width if `Bits` is 0.
+   * The words are not owned and must outlive the view.
+   */
+  template <unsigned Bits> class BitPacked {
+    static_assert(Bits <= 64, "at most 64 bits per value");
+    const uint64_t * words;
+    size_t count;
+    bitpacked_detail::Width<Bits> width;
+
+  public:
+    using value_type = bitpacked_detail::ValueType<Bits>;
+
+    /**
+     * Holds the words and width by value, so it stays valid after the view is destroyed.
+     */
+    class iterator {
+      const uint64_t * words;
+      bitpacked_detail::Width<Bits> width;
+      size_t index;
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = BitPacked::value_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = value_type;
+
+      iterator(const uint64_t * _words = nullptr, bitpacked_detail::Width<Bits> _width = {}, size_t _index = 0):words(_words),width(_width),index(_index){ }
+      value_type operator*() const { return static_cast<value_type>(bitpacked_detail::extract(words, index, width.bits())); }
+      value_type operator[](difference_type offset) const { return *(*this + offset); }
+      iterator & operator++() { ++index; return *this; }
+      iterator & operator--() { --index; return *this; }
+      iterator operator++(int) { auto copy = *this; ++index; return copy; }
+      iterator operator--(int) { auto copy = *this; --index; return copy; }
+      iterator & operator+=(difference_type offset) { index += offset; return *this; }
+      iterator & operator-=(difference_type offset) { index -= offset; return *this; }
+      iterator operator+(difference_type offset) const { return iterator(words, width, index + offset); }
+      iterator operator-(difference_type offset) const { return iterator(words, width, index - offset); }
+      difference_type operator-(const iterator &other) const { return static_cast<difference_type>(index) - static_cast<difference_type>(other.index); }
+      bool operator==(const iterator &other) const { return index == other.index; }
+      bool operator!=(const iterator &other) const { return index != other.index; }
+      bool operator<(const iterator &other) const { return index < other.index; }
+      bool operator>(const iterator &other) const { return index > other.index; }
+      bool operator<=(const iterator &other) const { return index <= other.index; }
+      bool operator>=(const iterator &other) const { return index >= other.index; }
+    };
+
+    BitPacked(const uint64_t * _words, size_t _count, bitpacked_detail::Width<Bits> _width = {}):words(_words),count(_count),width(_width){ }
+
+    size_t size() const { return count; }
+    unsigned bits() const { return width.bits(); }
+    value_type operator[](size_t index) const { return static_cast<value_type>(bitpacked_detail::extract(words, index, width.bits())); }
+
+    iterator begin() const { return iterator(words, width, 0); }
+    iterator end() const { return iterator(words, width, count); }
+
+    /**
+     * Returns a sequential iterable that unpacks 64 values at a time.
+     */
+    auto scan() const {
+      using Source = bitpacked_detail::UnpackSource<Bits>;
+      return compression_detail::DecodeIterable<Source>(Source(words, 0, count, width));
+    }
+
+    /**
+     * Unpacks the values `[first, first + n)` into `out`.
+     */
+    template <class T> void unpack(size_t first, size_t n, T * out) const {
+      size_t i = 0;
+      for (; i < n && (first + i) % bitpacked_detail::blockSize != 0; ++i) { out[i] = static_cast<T>((*this)[first + i]); }
+      auto unpackBlock = width.template unpacker<T>();
+      for (; i + bitpacked_detail::blockSize <= n; i += bitpacked_detail::blockSize) {
+        unpackBlock(words + (first + i) / 64 * width.bits(), out + i);
+      }
+      for (; i < n; ++i) { out[i] = static_cast<T>((*this)[first + i]); }
+    }
+  };
+
+  /**
+   * Returns a view of `size` values of `Bits` bits in the contiguous container of words `words`.
+   */
+  template <unsigned Bits, class W> BitPacked<Bits> bitpacked(const W &words, size_t size) {
+    static_assert(Bits > 0, "use bitpacked(words, size, bits) for a runtime width");
+    return BitPacked<Bits>(std::data(words), size);
+  }
+
+  /**
+   * Returns a view of `packed`. Throws `std::invalid_argument` if it was not packed with `Bits` bits.
+   */
+  template <unsigned Bits> BitPacked<Bits> bitpacked(const PackedBits &packed) {
+    if (packed.bits != Bits) {
+      throw std::invalid_argument("values were packed with " + std::to_string(packed.bits) + " bits, not " + std::to_string(Bits));
+    }
+    return bitpacked<Bits>(packed.words, packed.size);
+  }
+
+  template <unsigned Bits> BitPacked<Bits> bitpacked(PackedBits &&) = delete;
+
+  /**
+   * Returns a view of `size` values of `bits` bits in `words`.
+   * Throws `std::invalid_argument` unless `bits` is between 1 and 64.
+   */
+  template <class W> BitPacked<0> bitpacked(const W &words, size_t size, unsigned bits) {
+    bitpacked_detail::checkBits(bits);
+    return BitPacked<0>(std::data(words), size, bitpacked_detail::Width<0>{bits});
+  }
+
+  inline BitPacked<0> bitpacked(const PackedBits &packed) {
+    return bitpacked(packed.words, packed.size, packed.bits);
+  }
+
+  BitPacked<0> bitpacked(PackedBits &&) = delete;
+
+  /**
+   * Packs the values of `iterable` with `bits` bits each. Higher bits are discarded.
+   * Throws `std::invalid_argument` unless `bits` is between 1 and 64.
+   */
+  template <class T> PackedBits pack_bits(T && iterable, unsigned bits) {
+    bitpacked_detail::checkBits(bits);
+    PackedBits packed;
+    packed.bits = bits;
+    uint64_t current = 0;
+    unsigned filled = 0;
+    for (auto &&v: iterable) {
+      auto value = static_cast<uint64_t>(v) & bitpacked_detail::mask(bits);
+      current |= value << filled;
+      if (filled + bits >= 64) {
+        packed.words.push_back(current);
+        current = filled == 0 ? 0 : value >> (64 - filled);
+        filled = filled + bits - 64;
+      } else {
+        filled += bits;
+      }
+      ++packed.size;
+    }
+    if (filled > 0) { packed.words.push_back(current); }
+    return packed;
+  }
+
+  template <unsigned Bits, class T> PackedBits pack_bits(T && iterable) {
+    static_assert(Bits > 0 && Bits <= 64, "between 1 and 64 bits per value");
+    return pack_bits(std::forward<T>(iterable), Bits);
+  }
+
+}
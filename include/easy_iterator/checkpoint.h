@@ -0,0 +1,265 @@
+#pragma once
+
+/**
+ * Checkpoints and skipping for resumable iteration.
+ *
+ * `checkpoint(iterator)` returns a compact state of the iterator's position that can be stored and
+ * later passed to `resume(iterable, state)` to continue an equivalent iterable from that position.
+ * It is supported for ranges, `MakeIterable` generators and `zip` over checkpointable iterables.
+ * A generator `T` may provide `S checkpoint() const` and `void resume(const S &)` to control its
+ * state, otherwise a copy of `T` is used. States are plain values or tuples of them and can be
+ * serialized element-wise, e.g. with `for_each_element`.
+ * The state of a random-access iterator, such as a pointer into a mapped file, is its offset from
+ * the start of the iteration, so it is taken with `checkpoint(iterator, begin)`.
+ *
+ * `skip(iterable, n)` starts an iterable `n` elements later. This takes constant time for ranges,
+ * random-access iterators, generators providing `std::pair<bool, size_t> skip(size_t n)` and zips
+ * of those, so for such iterables the element count alone is a sufficient checkpoint. The hook
+ * skips at most `n` elements and returns whether the generator still has a value and the number of
+ * elements it skipped, which is less than `n` if it ended before.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "iterator.h"
+#include "range.h"
+#include "zip.h"
+
+namespace easy_iterator {
+
+  namespace checkpoint_detail {
+
+    template <class T, class = void> struct HasCheckpointHook: std::false_type { };
+    template <class T> struct HasCheckpointHook<T, std::void_t<decltype(std::declval<const T &>().checkpoint())>>: std::true_type { };
+
+    template <class T, bool = HasCheckpointHook<T>::value> struct GeneratorState { using type = std::decay_t<T>; };
+    template <class T> struct GeneratorState<T, true> { using type = std::decay_t<decltype(std::declval<const T &>().checkpoint())>; };
+
+    template <class T, class = void> struct HasSkipHook: std::false_type { };
+    template <class T> struct HasSkipHook<T, std::void_t<decltype(std::pair<bool, size_t>(std::declval<T &>().skip(size_t())))>>: std::true_type { };
+
+    template <class I, class E, class = void> struct IsRandomAccess: std::false_type { };
+    template <class I> struct IsRandomAccess<I, I, std::void_t<typename std::iterator_traits<I>::iterator_category>>: std::is_base_of<
+      std::random_access_iterator_tag,
+      typename std::iterator_traits<I>::iterator_category
+    > { };
+
+    template <class Z> using ZipIterator = Iterator<Z, increment::ByTupleIncrement, dereference::ByTupleDereference, compare::ByLastTupleElementMatch>;
+
+    /**
+     * Defines `State`, `save()` and `restore()` for checkpointable iterator types. `save(it, begin)`
+     * is defined for all of them, `save(it)` only if the state does not depend on the start.
+     * `restore()` is applied to an iterator at the start of its iterable.
+     */
+    template <class I, class = void> struct Checkpointer;
+
+    template <class T> struct Checkpointer<RangeIterator<T>> {
+      using State = T;
+      static State save(const RangeIterator<T> &it) { return it.value; }
+      static State save(const RangeIterator<T> &it, const RangeIterator<T> &) { return save(it); }
+      static void restore(RangeIterator<T> &it, const State &state) { it.value = state; }
+    };
+
+    template <class I> struct Checkpointer<I, std::enable_if_t<IsRandomAccess<I, I>::value>> {
+      using State = typename std::iterator_traits<I>::difference_type;
+      static State save(const I &it, const I &begin) { return it - begin; }
+      static void restore(I &it, const State &state) { it += state; }
+    };
+
+    template <class T, class M, M Method, class D> struct Checkpointer<Iterator<T, increment::ByMemberCall<T, M, Method>, D, compare::ByValue>> {
+      using I = Iterator<T, increment::ByMemberCall<T, M, Method>, D, compare::ByValue>;
+      using Value = typename GeneratorState<T>::type;
+
+      struct State {
+        Value value;
+        bool valid;
+      };
+
+      static State save(const I &it) {
+        if constexpr (HasCheckpointHook<T>::value) { return State{it.value.checkpoint(), it.state}; }
+        else { return State{it.value, it.state}; }
+      }
+
+      static State save(const I &it, const I &) { return save(it); }
+
+      static void restore(I &it, const State &state) {
+        if constexpr (HasCheckpointHook<T>::value) { it.value.resume(state.value); }
+        else { it.value = state.value; }
+        it.state = state.valid;
+      }
+    };
+
+    template <class ... Args> struct Checkpointer<ZipIterator<FlatTuple<Args...>>> {
+      using I = ZipIterator<FlatTuple<Args...>>;
+      using State = std::tuple<typename Checkpointer<Args>::State...>;
+
+      template <size_t ... Idx> static State save(const I &it, std::index_sequence<Idx...>) {
+        return State(Checkpointer<Args>::save(get<Idx>(it.value))...);
+      }
+
+      template <size_t ... Idx> static State save(const I &it, const I &begin, std::index_sequence<Idx...>) {
+        return State(Checkpointer<Args>::save(get<Idx>(it.value), get<Idx>(begin.value))...);
+      }
+
+      template <size_t ... Idx> static void restore(I &it, const State &state, std::index_sequence<Idx...>) {
+        (Checkpointer<Args>::restore(get<Idx>(it.value), std::get<Idx>(state)), ...);
+      }
+
+      static State save(const I &it) { return save(it, std::index_sequence_for<Args...>()); }
+      static State save(const I &it, const I &begin) { return save(it, begin, std::index_sequence_for<Args...>()); }
+      static void restore(I &it, const State &state) { restore(it, state, std::index_sequence_for<Args...>()); }
+    };
+
+    /**
+     * Advances `it` by at most `n` elements without passing `end`. Returns the number of skipped elements.
+     */
+    template <class I, class E> size_t skip(I &it, const E &end, size_t n);
+    template <class T> size_t skip(RangeIterator<T> &it, const RangeIterator<T> &end, size_t n);
+    template <class ... Args, class ... EndArgs> size_t skip(ZipIterator<FlatTuple<Args...>> &it, const ZipIterator<FlatTuple<EndArgs...>> &end, size_t n);
+    template <class T, class M, M Method, class D, class E> size_t skip(
+      Iterator<T, increment::ByMemberCall<T, M, Method>, D, compare::ByValue> &it, const E &end, size_t n
+    );
+
+    /**
+     * Advances `it` by exactly `n` elements without comparing against an end. Used for the members of
+     * a zip other than the last one, whose end may be unbounded as for `enumerate`.
+     */
+    template <class I> void advance(I &it, size_t n);
+    template <class T> void advance(RangeIterator<T> &it, size_t n);
+    template <class ... Args> void advance(ZipIterator<FlatTuple<Args...>> &it, size_t n);
+    template <class T, class M, M Method, class D> void advance(Iterator<T, increment::ByMemberCall<T, M, Method>, D, compare::ByValue> &it, size_t n);
+
+    template <class T> void advance(RangeIterator<T> &it, size_t n) {
+      it.value += static_cast<T>(n) * it.increment;
+    }
+
+    template <class ... Args, size_t ... Idx> void advanceZip(ZipIterator<FlatTuple<Args...>> &it, size_t n, std::index_sequence<Idx...>) {
+      (advance(get<Idx>(it.value), n), ...);
+    }
+
+    template <class ... Args> void advance(ZipIterator<FlatTuple<Args...>> &it, size_t n) {
+      advanceZip(it, n, std::index_sequence_for<Args...>());
+    }
+
+    template <class T, class M, M Method, class D> void advance(Iterator<T, increment::ByMemberCall<T, M, Method>, D, compare::ByValue> &it, size_t n) {
+      if constexpr (HasSkipHook<T>::value) {
+        if (n > 0 && it.state) { it.state = std::pair<bool, size_t>(it.value.skip(n)).first; }
+      } else {
+        for (; n > 0 && it.state; --n) { ++it; }
+      }
+    }
+
+    template <class I> void advance(I &it, size_t n) {
+      if constexpr (IsRandomAccess<I, I>::value) {
+        it += static_cast<typename std::iterator_traits<I>::difference_type>(n);
+      } else {
+        for (; n > 0; --n) { ++it; }
+      }
+    }
+
+    template <class T> size_t skip(RangeIterator<T> &it, const RangeIterator<T> &end, size_t n) {
+      auto remaining = static_cast<size_t>((end.value - it.value) / it.increment);
+      n = std::min(n, remaining);
+      it.value += static_cast<T>(n) * it.increment;
+      return n;
+    }
+
+    template <class ... Args, class ... EndArgs, size_t ... Idx> size_t skipZip(
+      ZipIterator<FlatTuple<Args...>> &it, const ZipIterator<FlatTuple<EndArgs...>> &end, size_t n, std::index_sequence<Idx...>
+    ) {
+      // the last element determines the end of a zip, the others are moved by the same count
+      constexpr size_t last = sizeof...(Args) - 1;
+      (void)end;
+      n = skip(get<last>(it.value), get<last>(end.value), n);
+      ((Idx != last ? advance(get<Idx>(it.value), n) : (void)0), ...);
+      return n;
+    }
+
+    template <class ... Args, class ... EndArgs> size_t skip(ZipIterator<FlatTuple<Args...>> &it, const ZipIterator<FlatTuple<EndArgs...>> &end, size_t n) {
+      return skipZip(it, end, n, std::index_sequence_for<Args...>());
+    }
+
+    template <class T, class M, M Method, class D, class E> size_t skip(
+      Iterator<T, increment::ByMemberCall<T, M, Method>, D, compare::ByValue> &it, const E &end, size_t n
+    ) {
+      if constexpr (HasSkipHook<T>::value) {
+        (void)end;
+        if (n == 0 || !it.state) { return 0; }
+        auto [valid, skipped] = std::pair<bool, size_t>(it.value.skip(n));
+        it.state = valid;
+        return std::min(skipped, n);
+      } else {
+        size_t count = 0;
+        for (; count < n && it != end; ++count) { ++it; }
+        return count;
+      }
+    }
+
+    template <class I, class E> size_t skip(I &it, const E &end, size_t n) {
+      if constexpr (IsRandomAccess<I, E>::value) {
+        n = std::min(n, static_cast<size_t>(end - it));
+        it += static_cast<typename std::iterator_traits<I>::difference_type>(n);
+        return n;
+      } else {
+        size_t count = 0;
+        for (; count < n && it != end; ++count) { ++it; }
+        return count;
+      }
+    }
+
+  }
+
+  /**
+   * The checkpoint state type for iterators of type `I`.
+   */
+  template <class I> using CheckpointState = typename checkpoint_detail::Checkpointer<std::decay_t<I>>::State;
+
+  /**
+   * Returns the state of `iterator`, which can be passed to `resume()`.
+   */
+  template <class I> CheckpointState<I> checkpoint(const I &iterator) {
+    return checkpoint_detail::Checkpointer<I>::save(iterator);
+  }
+
+  /**
+   * Returns the state of `iterator` relative to `begin`, the start of the same iteration. Required
+   * for random-access iterators and zips of them.
+   */
+  template <class I> CheckpointState<I> checkpoint(const I &iterator, const I &begin) {
+    return checkpoint_detail::Checkpointer<I>::save(iterator, begin);
+  }
+
+  /**
+   * Sets `iterator`, which must be at the start of its iterable, to the position stored in `state`.
+   */
+  template <class I> void restore(I &iterator, const CheckpointState<I> &state) {
+    checkpoint_detail::Checkpointer<I>::restore(iterator, state);
+  }
+
+  /**
+   * Returns an iterable that continues `iterable` from a checkpoint taken during a previous
+   * iteration of an equivalent iterable.
+   */
+  template <class T, class S> auto resume(T && iterable, const S &state) {
+    auto begin = iterable.begin();
+    auto end = iterable.end();
+    restore(begin, state);
+    return wrap(std::move(begin), std::move(end));
+  }
+
+  /**
+   * Returns an iterable that starts `n` elements after the start of `iterable`, or at its end.
+   */
+  template <class T> auto skip(T && iterable, size_t n) {
+    auto begin = iterable.begin();
+    auto end = iterable.end();
+    checkpoint_detail::skip(begin, end, n);
+    return wrap(std::move(begin), std::move(end));
+  }
+
+}
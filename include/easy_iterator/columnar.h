@@ -0,0 +1,478 @@
+#pragma once
+
+/**
+ * A simple binary columnar file format for persisting tables of arithmetic columns between
+ * pipeline stages. The file consists of a header with the schema, one 64 byte aligned segment per
+ * column holding the raw values in native byte order and optional per-block minima and maxima.
+ * `write_columns()` consumes a `zip` of columns, `ColumnarFile` maps a file into memory and
+ * returns zero-copy views that are zipped again for reading. Requires POSIX `mmap`.
+ * Usage:
+ *   write_columns("prices.col", zip(ids, prices));
+ *   ColumnarFile file("prices.col");
+ *   for (auto [id, price]: file.read_where<1, uint64_t, double>([](double, double max){ return max > 100; })) { ... }
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+#include "zip.h"
+
+namespace easy_iterator {
+
+  /**
+   * Thrown if a columnar file cannot be written or read, or does not match the requested schema.
+   */
+  struct ColumnarFileException: public std::runtime_error {
+    using std::runtime_error::runtime_error;
+  };
+
+  namespace columnar_detail {
+
+    constexpr char magic[8] = {'E', 'I', 'C', 'O', 'L', 'U', 'M', 'N'};
+    constexpr uint32_t version = 1;
+    constexpr uint32_t byteOrderMark = 0x01020304;
+    constexpr uint64_t alignment = 64;
+
+    enum class ColumnKind: uint32_t { Signed = 1, Unsigned = 2, Float = 3 };
+
+    struct Header {
+      char magic[8];
+      uint32_t version;
+      uint32_t byteOrder;
+      uint64_t rows;
+      uint64_t blockSize;
+      uint64_t columns;
+    };
+
+    struct ColumnHeader {
+      ColumnKind kind;
+      uint32_t size;
+      uint64_t offset;
+      uint64_t statsOffset;
+    };
+
+    template <class T> constexpr ColumnKind kindOf() {
+      static_assert(std::is_arithmetic<T>::value, "columns must have an arithmetic type");
+      return std::is_floating_point<T>::value ? ColumnKind::Float : std::is_signed<T>::value ? ColumnKind::Signed : ColumnKind::Unsigned;
+    }
+
+    inline uint64_t align(uint64_t offset) { return (offset + alignment - 1) / alignment * alignment; }
+
+    struct FileCloser {
+      void operator()(std::FILE * file) const { std::fclose(file); }
+    };
+    using File = std::unique_ptr<std::FILE, FileCloser>;
+
+    inline void writeBytes(std::FILE * file, const void * data, size_t size) {
+      if (size > 0 && std::fwrite(data, 1, size, file) != size) { throw ColumnarFileException("cannot write columnar file"); }
+    }
+
+    inline void pad(std::FILE * file, uint64_t &offset, uint64_t target) {
+      static const char zeros[alignment] = {};
+      writeBytes(file, zeros, target - offset);
+      offset = target;
+    }
+
+    /**
+     * Buffers one block of a column, collects its statistics and spills it to a temporary file.
+     */
+    template <class T> class ColumnBuffer {
+      File spill;
+      std::vector<T> block;
+      size_t blockSize;
+    public:
+      std::vector<T> minima, maxima;
+
+      explicit ColumnBuffer(size_t _blockSize):spill(std::tmpfile()),blockSize(_blockSize){
+        if (!spill) { throw ColumnarFileException("cannot create temporary column file"); }
+        block.reserve(blockSize);
+      }
+
+      void push(const T &value) {
+        block.push_back(value);
+        if (block.size() == blockSize) { flush(); }
+      }
+
+      void flush() {
+        if (block.empty()) { return; }
+        auto [min, max] = std::minmax_element(block.begin(), block.end());
+        minima.push_back(*min);
+        maxima.push_back(*max);
+        writeBytes(spill.get(), block.data(), block.size() * sizeof(T));
+        block.clear();
+      }
+
+      /** Appends the spilled values to `file` in large blocks. */
+      void copyTo(std::FILE * file) {
+        std::vector<char> buffer(size_t(1) << 20);
+        std::rewind(spill.get());
+        size_t count;
+        while ((count = std::fread(buffer.data(), 1, buffer.size(), spill.get())) > 0) { writeBytes(file, buffer.data(), count); }
+        if (std::ferror(spill.get())) { throw ColumnarFileException("cannot read temporary column file"); }
+      }
+    };
+
+    /**
+     * Visits only the rows of the selected row ranges. Gaps are skipped in constant time.
+     */
+    template <class I, class E> class RowRangeIterator {
+      I iterator;
+      E end;
+      // shared with the selection, so the iterator may outlive it, e.g. in `resume()`
+      std::shared_ptr<const std::vector<std::pair<size_t, size_t>>> ranges;
+      size_t rangeIndex = 0;
+      size_t position = 0;
+
+      void enterRange() {
+        if (rangeIndex < ranges->size() && (*ranges)[rangeIndex].first > position) {
+          position += checkpoint_detail::skip(iterator, end, (*ranges)[rangeIndex].first - position);
+        }
+      }
+    public:
+      RowRangeIterator(I _iterator, E _end, std::shared_ptr<const std::vector<std::pair<size_t, size_t>>> _ranges):
+        iterator(std::move(_iterator)),end(std::move(_end)),ranges(std::move(_ranges)){
+        enterRange();
+      }
+      decltype(auto) operator*() { return *iterator; }
+      RowRangeIterator & operator++() {
+        ++iterator;
+        if (++position == (*ranges)[rangeIndex].second) {
+          ++rangeIndex;
+          enterRange();
+        }
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return rangeIndex < ranges->size(); }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+
+      /** The index of the current row in the file. */
+      size_t row() const { return position; }
+
+      /** Moves forward to the first selected row at or after `row`. */
+      void seek(size_t row) {
+        while (rangeIndex < ranges->size() && (*ranges)[rangeIndex].second <= row) { ++rangeIndex; }
+        if (rangeIndex < ranges->size() && row > position) {
+          position += checkpoint_detail::skip(iterator, end, std::max(row, (*ranges)[rangeIndex].first) - position);
+        } else {
+          enterRange();
+        }
+      }
+    };
+
+  }
+
+  namespace checkpoint_detail {
+
+    /**
+     * The state of a row range iterator is the index of its current row.
+     */
+    template <class I, class E> struct Checkpointer<columnar_detail::RowRangeIterator<I, E>> {
+      using It = columnar_detail::RowRangeIterator<I, E>;
+      using State = size_t;
+      static State save(const It &it) { return it.row(); }
+      static State save(const It &it, const It &) { return it.row(); }
+      static void restore(It &it, const State &state) { it.seek(state); }
+    };
+
+  }
+
+  /**
+   * Writes rows into a columnar file. Values are spilled to temporary files block by block, the
+   * file at `path` is only created by `close()`.
+   */
+  template <class ... Ts> class ColumnWriter {
+    static_assert(sizeof...(Ts) > 0, "a columnar file needs at least one column");
+    std::filesystem::path path;
+    size_t blockSize;
+    bool statistics;
+    uint64_t rows = 0;
+    std::tuple<columnar_detail::ColumnBuffer<Ts>...> columns;
+    bool closed = false;
+
+    template <size_t ... Idx> void pushValues(std::index_sequence<Idx...>, const Ts &... values) {
+      (std::get<Idx>(columns).push(values), ...);
+    }
+
+  public:
+    /**
+     * Creates a writer with blocks of `blockSize` rows. If `statistics` is set, the minimum and
+     * maximum of every block are stored.
+     */
+    explicit ColumnWriter(std::filesystem::path _path, size_t _blockSize = 65536, bool _statistics = true):
+      path(std::move(_path)),blockSize(std::max<size_t>(1, _blockSize)),statistics(_statistics),columns(columnar_detail::ColumnBuffer<Ts>(blockSize)...){ }
+
+    void push(const Ts &... values) {
+      pushValues(std::index_sequence_for<Ts...>(), values...);
+      ++rows;
+    }
+
+    /** Pushes a row given as a tuple, e.g. the value of a `zip` iterator. */
+    template <class Tuple> void push_row(const Tuple &row) {
+      std::apply([this](const auto &... values){ push(values...); }, row);
+    }
+
+    uint64_t size() const { return rows; }
+
+    /**
+     * Writes the file. Returns the number of rows written.
+     */
+    uint64_t close() {
+      using namespace columnar_detail;
+      if (closed) { return rows; }
+      std::apply([](auto &... buffers){ (buffers.flush(), ...); }, columns);
+      const uint64_t blocks = (rows + blockSize - 1) / blockSize;
+
+      Header header{};
+      std::memcpy(header.magic, magic, sizeof(magic));
+      header.version = version;
+      header.byteOrder = byteOrderMark;
+      header.rows = rows;
+      header.blockSize = blockSize;
+      header.columns = sizeof...(Ts);
+      ColumnHeader columnHeaders[] = {ColumnHeader{kindOf<Ts>(), sizeof(Ts), 0, 0}...};
+      uint64_t offset = sizeof(Header) + sizeof(columnHeaders);
+      for (auto &column: columnHeaders) {
+        column.offset = align(offset);
+        offset = column.offset + rows * column.size;
+      }
+      if (statistics) {
+        for (auto &column: columnHeaders) {
+          column.statsOffset = align(offset);
+          offset = column.statsOffset + 2 * blocks * column.size;
+        }
+      }
+
+      File file(std::fopen(path.string().c_str(), "wb"));
+      if (!file) { throw ColumnarFileException("cannot create columnar file " + path.string()); }
+      writeBytes(file.get(), &header, sizeof(header));
+      writeBytes(file.get(), columnHeaders, sizeof(columnHeaders));
+      offset = sizeof(Header) + sizeof(columnHeaders);
+      size_t index = 0;
+      std::apply([&](auto &... buffers){
+        ((pad(file.get(), offset, columnHeaders[index].offset), buffers.copyTo(file.get()), offset += rows * columnHeaders[index++].size), ...);
+      }, columns);
+      if (statistics) {
+        index = 0;
+        std::apply([&](auto &... buffers){
+          ((
+            pad(file.get(), offset, columnHeaders[index].statsOffset),
+            writeBytes(file.get(), buffers.minima.data(), blocks * columnHeaders[index].size),
+            writeBytes(file.get(), buffers.maxima.data(), blocks * columnHeaders[index].size),
+            offset += 2 * blocks * columnHeaders[index++].size
+          ), ...);
+        }, columns);
+      }
+      if (std::fflush(file.get()) != 0) { throw ColumnarFileException("cannot write columnar file " + path.string()); }
+      closed = true;
+      return rows;
+    }
+  };
+
+  namespace columnar_detail {
+    template <class Row> struct WriterFor;
+    template <class ... Ts> struct WriterFor<std::tuple<Ts...>> { using type = ColumnWriter<std::decay_t<Ts>...>; };
+  }
+
+  /**
+   * Writes the rows of `rows`, usually a `zip` of columns, to a columnar file at `path`.
+   * Returns the number of rows written.
+   */
+  template <class Z> uint64_t write_columns(const std::filesystem::path &path, Z && rows, size_t blockSize = 65536, bool statistics = true) {
+    typename columnar_detail::WriterFor<std::decay_t<decltype(*rows.begin())>>::type writer(path, blockSize, statistics);
+    for (auto &&row: rows) { writer.push_row(row); }
+    return writer.close();
+  }
+
+  /**
+   * A zero-copy view of a column in a mapped file.
+   */
+  template <class T> class ColumnView {
+    const T * first;
+    const T * last;
+  public:
+    ColumnView(const T * _first, const T * _last):first(_first),last(_last){ }
+    const T * begin() const { return first; }
+    const T * end() const { return last; }
+    const T * data() const { return first; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    const T & operator[](size_t index) const { return first[index]; }
+  };
+
+  /**
+   * The iterable returned by `ColumnarFile::read_where()`.
+   */
+  template <class ... Ts> class ColumnSelection {
+    std::tuple<ColumnView<Ts>...> views;
+    std::shared_ptr<const std::vector<std::pair<size_t, size_t>>> ranges;
+  public:
+    ColumnSelection(std::tuple<ColumnView<Ts>...> _views, std::vector<std::pair<size_t, size_t>> _ranges):
+      views(std::move(_views)),ranges(std::make_shared<const std::vector<std::pair<size_t, size_t>>>(std::move(_ranges))){ }
+
+    /** The selected row ranges as `[first, last)` pairs. */
+    const std::vector<std::pair<size_t, size_t>> & row_ranges() const { return *ranges; }
+
+    auto begin() const {
+      auto zipped = std::apply([](const auto &... columns){ return zip(columns...); }, views);
+      auto it = zipped.begin();
+      auto end = zipped.end();
+      return columnar_detail::RowRangeIterator<std::decay_t<decltype(it)>, std::decay_t<decltype(end)>>(std::move(it), std::move(end), ranges);
+    }
+    IterationEnd end() const { return IterationEnd(); }
+  };
+
+  /**
+   * A read-only memory mapping of a columnar file. Views and iterables returned by the file refer
+   * to the mapping and must not outlive it.
+   */
+  class ColumnarFile {
+    const char * base = nullptr;
+    size_t length = 0;
+    columnar_detail::Header header{};
+    const columnar_detail::ColumnHeader * columnHeaders = nullptr;
+
+    void check(bool condition, const std::string &message) const {
+      if (!condition) { throw ColumnarFileException(message); }
+    }
+
+    const columnar_detail::ColumnHeader & columnHeader(size_t column) const {
+      check(column < header.columns, "column index out of range");
+      return columnHeaders[column];
+    }
+
+    template <class T> const columnar_detail::ColumnHeader & typedHeader(size_t column) const {
+      auto &result = columnHeader(column);
+      check(result.kind == columnar_detail::kindOf<T>() && result.size == sizeof(T), "column " + std::to_string(column) + " has a different type");
+      return result;
+    }
+
+    void unmap() {
+      if (base) { munmap(const_cast<char *>(base), length); }
+      base = nullptr;
+    }
+
+  public:
+    explicit ColumnarFile(const std::filesystem::path &path) {
+      using namespace columnar_detail;
+      int descriptor = open(path.string().c_str(), O_RDONLY);
+      check(descriptor >= 0, "cannot open columnar file " + path.string());
+      struct stat status;
+      if (fstat(descriptor, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(Header)) {
+        ::close(descriptor);
+        throw ColumnarFileException("invalid columnar file " + path.string());
+      }
+      length = static_cast<size_t>(status.st_size);
+      void * mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, descriptor, 0);
+      ::close(descriptor);
+      check(mapping != MAP_FAILED, "cannot map columnar file " + path.string());
+      base = static_cast<const char *>(mapping);
+      madvise(mapping, length, MADV_SEQUENTIAL);
+
+      try {
+        std::memcpy(&header, base, sizeof(Header));
+        check(std::memcmp(header.magic, magic, sizeof(magic)) == 0, "not a columnar file: " + path.string());
+        check(header.version == version, "unsupported columnar file version");
+        check(header.byteOrder == byteOrderMark, "columnar file has a different byte order");
+        check(header.blockSize > 0, "invalid columnar file " + path.string());
+        check(header.columns <= (length - sizeof(Header)) / sizeof(ColumnHeader), "truncated columnar file");
+        columnHeaders = reinterpret_cast<const ColumnHeader *>(base + sizeof(Header));
+        for (size_t column = 0; column < header.columns; ++column) {
+          auto &c = columnHeaders[column];
+          check(c.offset % alignment == 0 && c.offset <= length && header.rows <= (length - c.offset) / std::max<uint32_t>(1, c.size), "truncated columnar file");
+          check(c.statsOffset % alignment == 0 && (c.statsOffset == 0 || (c.statsOffset <= length && 2 * blocks() * c.size <= length - c.statsOffset)), "truncated columnar file");
+        }
+      } catch (...) {
+        unmap();
+        throw;
+      }
+    }
+
+    ColumnarFile(ColumnarFile && other):base(other.base),length(other.length),header(other.header),columnHeaders(other.columnHeaders){
+      other.base = nullptr;
+    }
+    ColumnarFile(const ColumnarFile &) = delete;
+    ColumnarFile & operator=(const ColumnarFile &) = delete;
+    ~ColumnarFile() { unmap(); }
+
+    size_t rows() const { return header.rows; }
+    size_t columns() const { return header.columns; }
+    size_t block_size() const { return header.blockSize; }
+    size_t blocks() const { return (header.rows + header.blockSize - 1) / header.blockSize; }
+    bool has_statistics(size_t column) const { return columnHeader(column).statsOffset != 0; }
+
+    /**
+     * Returns a view of `column`. Throws if the column does not have type `T`.
+     */
+    template <class T> ColumnView<T> column(size_t column) const {
+      auto first = reinterpret_cast<const T *>(base + typedHeader<T>(column).offset);
+      return ColumnView<T>(first, first + header.rows);
+    }
+
+    template <class T> T block_min(size_t column, size_t block) const {
+      auto &c = typedHeader<T>(column);
+      check(c.statsOffset != 0 && block < blocks(), "no statistics for block");
+      return reinterpret_cast<const T *>(base + c.statsOffset)[block];
+    }
+
+    template <class T> T block_max(size_t column, size_t block) const {
+      auto &c = typedHeader<T>(column);
+      check(c.statsOffset != 0 && block < blocks(), "no statistics for block");
+      return reinterpret_cast<const T *>(base + c.statsOffset)[blocks() + block];
+    }
+
+    /**
+     * Returns a `zip` of all columns. Throws if the schema differs from `Ts...`.
+     */
+    template <class ... Ts> auto read() const {
+      check(sizeof...(Ts) == header.columns, "columnar file has " + std::to_string(header.columns) + " columns");
+      return readColumns<Ts...>(std::index_sequence_for<Ts...>());
+    }
+
+    /**
+     * Returns the rows of all blocks for which `predicate(min, max)` of column `Column` is true.
+     * Other blocks are skipped without being read. If the file has no statistics, all rows are returned.
+     */
+    template <size_t Column, class ... Ts, class P> ColumnSelection<Ts...> read_where(P && predicate) const {
+      using T = std::tuple_element_t<Column, std::tuple<Ts...>>;
+      check(sizeof...(Ts) == header.columns, "columnar file has " + std::to_string(header.columns) + " columns");
+      std::vector<std::pair<size_t, size_t>> ranges;
+      bool statistics = has_statistics(Column);
+      for (size_t block = 0; block < blocks(); ++block) {
+        if (statistics && !predicate(block_min<T>(Column, block), block_max<T>(Column, block))) { continue; }
+        size_t first = block * header.blockSize, last = std::min<size_t>(first + header.blockSize, header.rows);
+        if (!ranges.empty() && ranges.back().second == first) {
+          ranges.back().second = last;
+        } else {
+          ranges.emplace_back(first, last);
+        }
+      }
+      return ColumnSelection<Ts...>(viewColumns<Ts...>(std::index_sequence_for<Ts...>()), std::move(ranges));
+    }
+
+  private:
+    template <class ... Ts, size_t ... Idx> std::tuple<ColumnView<Ts>...> viewColumns(std::index_sequence<Idx...>) const {
+      return std::tuple<ColumnView<Ts>...>(column<Ts>(Idx)...);
+    }
+
+    template <class ... Ts, size_t ... Idx> auto readColumns(std::index_sequence<Idx...>) const {
+      return zip(column<Ts>(Idx)...);
+    }
+  };
+
+}
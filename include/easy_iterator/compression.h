@@ -0,0 +1,403 @@
+#pragma once
+
+/**
+ * Decoding iterables for compressed integer sequences and the matching encoders.
+ * - `delta_encode(iterable)` / `delta_decode(iterable)`: differences to the previous value.
+ * - `varint_encode(iterable)` / `varint_decode<T>(bytes)`: LEB128 variable length integers.
+ * - `svb_encode(iterable)` / `svb_decode(control, data, count)`: StreamVByte, which stores the
+ *   byte lengths of four 32 bit values in one control byte separately from the data bytes.
+ * Decoders fill a small internal buffer one block at a time and yield the values from there. Blocks
+ * are decoded with SSE2 / SSSE3 if the target supports it, unless `EASY_ITERATOR_NO_SIMD` is defined.
+ * Usage:
+ *   auto bytes = varint_encode(delta_encode(postings));
+ *   for (auto id: delta_decode(varint_decode<uint32_t>(bytes))) { ... }
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(EASY_ITERATOR_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define EASY_ITERATOR_SSE2 1
+#endif
+#if !defined(EASY_ITERATOR_NO_SIMD) && defined(__SSSE3__)
+#include <tmmintrin.h>
+#define EASY_ITERATOR_SSSE3 1
+#endif
+
+#include "iterator.h"
+
+namespace easy_iterator {
+
+  /**
+   * Thrown if encoded data ends within a value.
+   */
+  struct DecodeException: public std::runtime_error {
+    using std::runtime_error::runtime_error;
+  };
+
+  namespace compression_detail {
+
+    constexpr size_t blockSize = 64;
+
+    /**
+     * Yields the values that `Source::decode(buffer, blockSize)` writes into an internal buffer.
+     * The iteration ends when a block is empty.
+     */
+    template <class Source> class BlockIterator {
+      using Value = typename Source::value_type;
+      Source source;
+      std::array<Value, blockSize> buffer;
+      size_t position = 0;
+      size_t available = 0;
+    public:
+      explicit BlockIterator(Source _source):source(std::move(_source)){
+        available = source.decode(buffer.data(), blockSize);
+      }
+      const Value & operator*() const { return buffer[position]; }
+      BlockIterator & operator++() {
+        if (++position == available) {
+          available = source.decode(buffer.data(), blockSize);
+          position = 0;
+        }
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return position < available; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+    /**
+     * Adds `previous` and the prefix sums of `values[0..count)` in place and returns the last sum.
+     */
+    template <class T> T prefixSum(T * values, size_t count, T previous) {
+      size_t i = 0;
+#ifdef EASY_ITERATOR_SSE2
+      if constexpr (std::is_integral<T>::value && sizeof(T) == 4) {
+        __m128i carry = _mm_set1_epi32(static_cast<int>(previous));
+        for (; i + 4 <= count; i += 4) {
+          __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+          x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+          x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+          x = _mm_add_epi32(x, carry);
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(values + i), x);
+          carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+        if (i > 0) { previous = values[i - 1]; }
+      }
+#endif
+      for (; i < count; ++i) { previous = values[i] = static_cast<T>(values[i] + previous); }
+      return previous;
+    }
+
+    template <class I, class E> class DeltaDecodeSource {
+      I iterator;
+      E end;
+    public:
+      using value_type = std::decay_t<decltype(*std::declval<I &>())>;
+    private:
+      value_type previous = value_type();
+    public:
+      DeltaDecodeSource(I _iterator, E _end):iterator(std::move(_iterator)),end(std::move(_end)){ }
+      size_t decode(value_type * out, size_t max) {
+        size_t count = 0;
+        for (; count < max && iterator != end; ++count, ++iterator) { out[count] = *iterator; }
+        previous = prefixSum(out, count, previous);
+        return count;
+      }
+    };
+
+    template <class T> class VarintDecodeSource {
+      // values are assembled unsigned, since shifting into the sign bit of a signed type is undefined
+      using U = std::make_unsigned_t<T>;
+
+      const uint8_t * current;
+      const uint8_t * last;
+      bool singleByte = true;
+
+      U decodeTail(U value, unsigned shift) {
+        uint8_t byte;
+        do {
+          if (current == last) { throw DecodeException("varint data ends within a value"); }
+          byte = *current++;
+          if (shift < std::numeric_limits<U>::digits) { value |= static_cast<U>(static_cast<U>(byte & 0x7f) << shift); }
+          shift += 7;
+        } while (byte & 0x80);
+        return value;
+      }
+
+      /** Decodes one value. The first three bytes are unrolled if they are in bounds. */
+      U decodeUnsigned() {
+        if (last - current < 3) { return decodeTail(0, 0); }
+        uint8_t byte = current[0];
+        U value = static_cast<U>(byte & 0x7f);
+        if (byte < 0x80) { current += 1; return value; }
+        byte = current[1];
+        value |= static_cast<U>(static_cast<U>(byte & 0x7f) << 7);
+        if (byte < 0x80) { current += 2; return value; }
+        byte = current[2];
+        if (14 < std::numeric_limits<U>::digits) { value |= static_cast<U>(static_cast<U>(byte & 0x7f) << (14 % std::numeric_limits<U>::digits)); }
+        current += 3;
+        return byte < 0x80 ? value : decodeTail(value, 21);
+      }
+
+      T decodeValue() { return static_cast<T>(decodeUnsigned()); }
+
+    public:
+      using value_type = T;
+      VarintDecodeSource(const uint8_t * _current, const uint8_t * _last):current(_current),last(_last){ }
+
+      size_t decode(T * out, size_t max) {
+        size_t count = 0;
+        while (count < max && current != last) {
+#ifdef EASY_ITERATOR_SSE2
+          // after a single byte value, copy the following run of single byte values 16 bytes at a time
+          if (singleByte && max - count >= 16 && last - current >= 16) {
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(current))));
+            unsigned run = mask == 0 ? 16 : static_cast<unsigned>(__builtin_ctz(mask));
+            for (unsigned i = 0; i < 16; ++i) { out[count + i] = current[i]; }
+            current += run;
+            count += run;
+            if (run == 16 || count == max) { continue; }
+          }
+#endif
+          T value = decodeValue();
+          out[count++] = value;
+          singleByte = value < 0x80;
+        }
+        return count;
+      }
+    };
+
+    /** Byte length of a StreamVByte value with the given 2 bit code. */
+    constexpr size_t svbLength(unsigned code) { return code + 1; }
+
+    constexpr unsigned svbCode(uint32_t value) {
+      return value < (1u << 8) ? 0 : value < (1u << 16) ? 1 : value < (1u << 24) ? 2 : 3;
+    }
+
+    struct SvbTables {
+      std::array<uint8_t, 256> lengths{};
+      std::array<std::array<uint8_t, 16>, 256> shuffles{};
+    };
+
+    /** The data length and the `pshufb` mask that expands the data of each control byte. */
+    constexpr SvbTables makeSvbTables() {
+      SvbTables tables;
+      for (unsigned control = 0; control < 256; ++control) {
+        uint8_t offset = 0;
+        for (unsigned lane = 0; lane < 4; ++lane) {
+          auto length = svbLength((control >> (2 * lane)) & 3);
+          for (unsigned byte = 0; byte < 4; ++byte) {
+            tables.shuffles[control][4 * lane + byte] = byte < length ? static_cast<uint8_t>(offset + byte) : 0xff;
+          }
+          offset = static_cast<uint8_t>(offset + length);
+        }
+        tables.lengths[control] = offset;
+      }
+      return tables;
+    }
+
+    inline const SvbTables & svbTables() {
+      static constexpr SvbTables tables = makeSvbTables();
+      return tables;
+    }
+
+    class SvbDecodeSource {
+      const uint8_t * control;
+      const uint8_t * data;
+      const uint8_t * dataEnd;
+      size_t remaining;
+
+      void decodeScalar(uint32_t * out, unsigned key, size_t count) {
+        for (size_t lane = 0; lane < count; ++lane) {
+          auto length = svbLength((key >> (2 * lane)) & 3);
+          if (static_cast<size_t>(dataEnd - data) < length) { throw DecodeException("StreamVByte data ends within a value"); }
+          uint32_t value = 0;
+          for (size_t byte = 0; byte < length; ++byte) { value |= static_cast<uint32_t>(data[byte]) << (8 * byte); }
+          out[lane] = value;
+          data += length;
+        }
+      }
+
+    public:
+      using value_type = uint32_t;
+      SvbDecodeSource(const uint8_t * _control, const uint8_t * _data, const uint8_t * _dataEnd, size_t count):
+        control(_control),data(_data),dataEnd(_dataEnd),remaining(count){ }
+
+      size_t decode(uint32_t * out, size_t max) {
+        size_t count = 0;
+        while (count + 4 <= max && remaining >= 4) {
+          unsigned key = *control++;
+#ifdef EASY_ITERATOR_SSSE3
+          if (dataEnd - data >= 16) {
+            auto &tables = svbTables();
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+            __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tables.shuffles[key].data()));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + count), _mm_shuffle_epi8(bytes, shuffle));
+            data += tables.lengths[key];
+            count += 4;
+            remaining -= 4;
+            continue;
+          }
+#endif
+          decodeScalar(out + count, key, 4);
+          count += 4;
+          remaining -= 4;
+        }
+        if (count + remaining <= max && remaining > 0) {
+          decodeScalar(out + count, *control++, remaining);
+          count += remaining;
+          remaining = 0;
+        }
+        return count;
+      }
+    };
+
+    /**
+     * Iterable over the values decoded by `Source`.
+     */
+    template <class Source> class DecodeIterable {
+      Source source;
+    public:
+      explicit DecodeIterable(Source _source):source(std::move(_source)){ }
+      BlockIterator<Source> begin() const { return BlockIterator<Source>(source); }
+      IterationEnd end() const { return IterationEnd(); }
+    };
+
+    /**
+     * Yields the differences of consecutive values, starting with the first value.
+     */
+    template <class I, class E> class DeltaEncodeIterator {
+      I iterator;
+      E end;
+      using Value = std::decay_t<decltype(*std::declval<I &>())>;
+      Value previous = Value();
+    public:
+      DeltaEncodeIterator(I _iterator, E _end):iterator(std::move(_iterator)),end(std::move(_end)){ }
+      Value operator*() { return static_cast<Value>(*iterator - previous); }
+      DeltaEncodeIterator & operator++() {
+        previous = *iterator;
+        ++iterator;
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return iterator != end; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+    template <class T> class DeltaEncodeIterable {
+      T iterable;
+    public:
+      explicit DeltaEncodeIterable(T && _iterable):iterable(std::forward<T>(_iterable)){ }
+      auto begin() {
+        using I = std::decay_t<decltype(iterable.begin())>;
+        using E = std::decay_t<decltype(iterable.end())>;
+        return DeltaEncodeIterator<I, E>(iterable.begin(), iterable.end());
+      }
+      IterationEnd end() const { return IterationEnd(); }
+    };
+
+    template <class T> class DeltaDecodeIterable {
+      T iterable;
+    public:
+      explicit DeltaDecodeIterable(T && _iterable):iterable(std::forward<T>(_iterable)){ }
+      auto begin() {
+        using I = std::decay_t<decltype(iterable.begin())>;
+        using E = std::decay_t<decltype(iterable.end())>;
+        return BlockIterator<DeltaDecodeSource<I, E>>(DeltaDecodeSource<I, E>(iterable.begin(), iterable.end()));
+      }
+      IterationEnd end() const { return IterationEnd(); }
+    };
+
+    template <class B> const uint8_t * bytesBegin(const B &bytes) { return reinterpret_cast<const uint8_t *>(std::data(bytes)); }
+    template <class B> const uint8_t * bytesEnd(const B &bytes) { return bytesBegin(bytes) + std::size(bytes); }
+
+  }
+
+  /**
+   * StreamVByte encoded 32 bit integers: one control byte with the 2 bit length codes of four
+   * values, followed by their little endian bytes in `data`.
+   */
+  struct SvbEncoded {
+    std::vector<uint8_t> control;
+    std::vector<uint8_t> data;
+    size_t count = 0;
+  };
+
+  /**
+   * Returns the differences of consecutive values of `iterable`, starting with the first value.
+   */
+  template <class T> compression_detail::DeltaEncodeIterable<T> delta_encode(T && iterable) {
+    return compression_detail::DeltaEncodeIterable<T>(std::forward<T>(iterable));
+  }
+
+  /**
+   * Returns the prefix sums of `iterable`, which reverses `delta_encode`.
+   */
+  template <class T> compression_detail::DeltaDecodeIterable<T> delta_decode(T && iterable) {
+    return compression_detail::DeltaDecodeIterable<T>(std::forward<T>(iterable));
+  }
+
+  /**
+   * Encodes the unsigned values of `iterable` as LEB128 variable length integers.
+   */
+  template <class T> std::vector<uint8_t> varint_encode(T && iterable) {
+    std::vector<uint8_t> bytes;
+    for (auto &&v: iterable) {
+      auto value = static_cast<std::make_unsigned_t<std::decay_t<decltype(v)>>>(v);
+      while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value = static_cast<decltype(value)>(value >> 7);
+      }
+      bytes.push_back(static_cast<uint8_t>(value));
+    }
+    return bytes;
+  }
+
+  /**
+   * Decodes the LEB128 integers in the contiguous byte container `bytes`, which must outlive the result.
+   */
+  template <class T = uint32_t, class B> auto varint_decode(const B &bytes) {
+    using Source = compression_detail::VarintDecodeSource<T>;
+    return compression_detail::DecodeIterable<Source>(Source(compression_detail::bytesBegin(bytes), compression_detail::bytesEnd(bytes)));
+  }
+
+  /**
+   * Encodes the 32 bit values of `iterable` with StreamVByte.
+   */
+  template <class T> SvbEncoded svb_encode(T && iterable) {
+    SvbEncoded result;
+    unsigned lane = 0;
+    for (auto &&v: iterable) {
+      auto value = static_cast<uint32_t>(v);
+      if (lane == 0) { result.control.push_back(0); }
+      auto code = compression_detail::svbCode(value);
+      result.control.back() = static_cast<uint8_t>(result.control.back() | (code << (2 * lane)));
+      for (size_t byte = 0; byte < compression_detail::svbLength(code); ++byte) { result.data.push_back(static_cast<uint8_t>(value >> (8 * byte))); }
+      lane = (lane + 1) % 4;
+      ++result.count;
+    }
+    return result;
+  }
+
+  /**
+   * Decodes `count` StreamVByte values. `control` and `data` are contiguous byte containers that must outlive the result.
+   */
+  template <class C, class D> auto svb_decode(const C &control, const D &data, size_t count) {
+    if (std::size(control) * 4 < count) { throw DecodeException("StreamVByte control bytes are missing"); }
+    using namespace compression_detail;
+    return DecodeIterable<SvbDecodeSource>(SvbDecodeSource(bytesBegin(control), bytesBegin(data), bytesEnd(data), count));
+  }
+
+  inline auto svb_decode(const SvbEncoded &encoded) {
+    return svb_decode(encoded.control, encoded.data, encoded.count);
+  }
+
+}
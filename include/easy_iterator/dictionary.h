@@ -0,0 +1,313 @@
+#pragma once
+
+/**
+ * Dictionary encoded columns. `dict_column(dictionary, codes)` yields `dictionary[code]` for every
+ * code. Predicates passed to `count_if`, `matching_rows` and `filter` are evaluated once per
+ * dictionary entry, the rows are then matched by their codes alone. If the matching codes form a
+ * contiguous range, which `dict_encode` makes likely for ordered predicates by sorting the
+ * dictionary, contiguous codes are compared 16 bytes at a time with SSE2.
+ * Usage:
+ *   auto cities = dict_encode(cityColumn);
+ *   auto count = count_if(cities, [](const std::string &city){ return city < "M"; });
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(EASY_ITERATOR_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define EASY_ITERATOR_SSE2 1
+#endif
+
+#include "iterator.h"
+
+namespace easy_iterator {
+
+  /**
+   * The set of dictionary codes that satisfy a predicate.
+   */
+  class CodeMatcher {
+  public:
+    enum class Kind { none, range, table };
+
+  private:
+    std::vector<uint8_t> table;
+    Kind kind = Kind::none;
+    size_t first = 0;
+    size_t last = 0;
+
+  public:
+    /**
+     * Evaluates `predicate` for every entry of `dictionary`.
+     */
+    template <class D, class P> CodeMatcher(const D &dictionary, P && predicate) {
+      for (auto &&entry: dictionary) { table.push_back(predicate(entry) ? 1 : 0); }
+      auto begin = std::find(table.begin(), table.end(), 1);
+      if (begin == table.end()) { return; }
+      first = static_cast<size_t>(begin - table.begin());
+      last = static_cast<size_t>(table.rend() - std::find(table.rbegin(), table.rend(), 1)) - 1;
+      kind = std::find(table.begin() + first, table.begin() + last, 0) == table.begin() + last ? Kind::range : Kind::table;
+    }
+
+    Kind type() const { return kind; }
+    /** The smallest and largest matching code. */
+    size_t first_code() const { return first; }
+    size_t last_code() const { return last; }
+
+    template <class C> bool operator()(const C &code) const {
+      return static_cast<size_t>(code) < table.size() && table[static_cast<size_t>(code)];
+    }
+  };
+
+  namespace dictionary_detail {
+
+    template <class C, class = void> struct IsContiguous: std::false_type { };
+    template <class C> struct IsContiguous<C, std::void_t<decltype(std::data(std::declval<C &>())), decltype(std::size(std::declval<C &>()))>>: std::true_type { };
+
+    /**
+     * Calls `f(index, mask)` for every block of 16 bytes of codes with the bits of `mask` marking
+     * the bytes of codes in `[first, first + width]`. Returns the number of codes processed.
+     */
+    template <class C, class F> size_t matchRangeBlocks(const C * codes, size_t count, C first, C width, F && f) {
+      size_t i = 0;
+#ifdef EASY_ITERATOR_SSE2
+      if constexpr (std::is_unsigned<C>::value && (sizeof(C) == 1 || sizeof(C) == 2 || sizeof(C) == 4)) {
+        constexpr size_t lanes = 16 / sizeof(C);
+        // unsigned x <= width is evaluated as a signed comparison with flipped sign bits
+        const C sign = static_cast<C>(C(1) << (8 * sizeof(C) - 1));
+        auto broadcast = [](C value) {
+          if constexpr (sizeof(C) == 1) { return _mm_set1_epi8(static_cast<char>(value)); }
+          else if constexpr (sizeof(C) == 2) { return _mm_set1_epi16(static_cast<short>(value)); }
+          else { return _mm_set1_epi32(static_cast<int>(value)); }
+        };
+        const __m128i low = broadcast(first), limit = broadcast(static_cast<C>(width ^ sign)), flip = broadcast(sign);
+        for (; i + lanes <= count; i += lanes) {
+          __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(codes + i));
+          __m128i greater;
+          if constexpr (sizeof(C) == 1) { greater = _mm_cmpgt_epi8(_mm_xor_si128(_mm_sub_epi8(x, low), flip), limit); }
+          else if constexpr (sizeof(C) == 2) { greater = _mm_cmpgt_epi16(_mm_xor_si128(_mm_sub_epi16(x, low), flip), limit); }
+          else { greater = _mm_cmpgt_epi32(_mm_xor_si128(_mm_sub_epi32(x, low), flip), limit); }
+          f(i, ~static_cast<unsigned>(_mm_movemask_epi8(greater)) & 0xffffu);
+        }
+      }
+#else
+      (void)codes; (void)count; (void)first; (void)width; (void)f;
+#endif
+      return i;
+    }
+
+    /**
+     * Whether the matching codes are a range of values representable by `Code`.
+     */
+    template <class Code> bool isCodeRange(const CodeMatcher &matcher) {
+      return std::is_unsigned<Code>::value && matcher.type() == CodeMatcher::Kind::range && matcher.last_code() <= std::numeric_limits<Code>::max();
+    }
+
+    /**
+     * Calls `f(row)` for every row whose code matches.
+     */
+    template <class C, class F> void forEachMatch(const C &codes, const CodeMatcher &matcher, F && f) {
+      if (matcher.type() == CodeMatcher::Kind::none) { return; }
+      size_t row = 0;
+      if constexpr (IsContiguous<const C>::value) {
+        using Code = std::decay_t<decltype(*std::data(codes))>;
+        auto data = std::data(codes);
+        size_t count = std::size(codes);
+        if (isCodeRange<Code>(matcher)) {
+          auto first = static_cast<Code>(matcher.first_code());
+          auto width = static_cast<Code>(matcher.last_code() - matcher.first_code());
+          row = matchRangeBlocks(data, count, first, width, [&](size_t index, unsigned mask) {
+            while (mask != 0) {
+              f(index + static_cast<size_t>(__builtin_ctz(mask)) / sizeof(Code));
+              mask &= ~(((1u << sizeof(Code)) - 1) << __builtin_ctz(mask));
+            }
+          });
+          for (; row < count; ++row) {
+            if (static_cast<Code>(data[row] - first) <= width) { f(row); }
+          }
+          return;
+        }
+        for (; row < count; ++row) {
+          if (matcher(data[row])) { f(row); }
+        }
+      } else {
+        for (auto &&code: codes) {
+          if (matcher(code)) { f(row); }
+          ++row;
+        }
+      }
+    }
+
+    template <class C> size_t countMatches(const C &codes, const CodeMatcher &matcher) {
+      if (matcher.type() == CodeMatcher::Kind::none) { return 0; }
+      if constexpr (IsContiguous<const C>::value) {
+        using Code = std::decay_t<decltype(*std::data(codes))>;
+        auto data = std::data(codes);
+        size_t count = std::size(codes);
+        size_t matches = 0;
+        size_t row = 0;
+        if (isCodeRange<Code>(matcher)) {
+          auto first = static_cast<Code>(matcher.first_code());
+          auto width = static_cast<Code>(matcher.last_code() - matcher.first_code());
+          row = matchRangeBlocks(data, count, first, width, [&](size_t, unsigned mask) {
+            matches += static_cast<size_t>(__builtin_popcount(mask)) / sizeof(Code);
+          });
+          for (; row < count; ++row) { matches += static_cast<Code>(data[row] - first) <= width; }
+          return matches;
+        }
+        for (; row < count; ++row) { matches += matcher(data[row]); }
+        return matches;
+      } else {
+        size_t matches = 0;
+        for (auto &&code: codes) { matches += matcher(code); }
+        return matches;
+      }
+    }
+
+    /**
+     * Dereferences codes through the dictionary.
+     */
+    template <class D, class I> class DecodingIterator {
+      const D * dictionary;
+      I code;
+    public:
+      DecodingIterator(const D &_dictionary, I _code):dictionary(&_dictionary),code(std::move(_code)){ }
+      decltype(auto) operator*() const { return (*dictionary)[static_cast<size_t>(*code)]; }
+      DecodingIterator & operator++() {
+        ++code;
+        return *this;
+      }
+      template <class E> bool operator!=(const E &end) const { return code != end; }
+      template <class E> bool operator==(const E &end) const { return code == end; }
+    };
+
+    /**
+     * Dereferences only the codes accepted by a `CodeMatcher`.
+     */
+    template <class D, class I, class E> class FilteringIterator {
+      const D * dictionary;
+      const CodeMatcher * matcher;
+      I code;
+      E end;
+
+      void findNext() {
+        while (code != end && !(*matcher)(*code)) { ++code; }
+      }
+    public:
+      FilteringIterator(const D &_dictionary, const CodeMatcher &_matcher, I _code, E _end):
+        dictionary(&_dictionary),matcher(&_matcher),code(std::move(_code)),end(std::move(_end)){
+        findNext();
+      }
+      decltype(auto) operator*() const { return (*dictionary)[static_cast<size_t>(*code)]; }
+      FilteringIterator & operator++() {
+        ++code;
+        findNext();
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return code != end; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+  }
+
+  /**
+   * A column of `codes` that index into `dictionary`. Both are stored by reference for lvalues and
+   * by value otherwise.
+   */
+  template <class D, class C> class DictColumn {
+    D dict;
+    C codeColumn;
+
+  public:
+    DictColumn(D && _dictionary, C && _codes):dict(std::forward<D>(_dictionary)),codeColumn(std::forward<C>(_codes)){ }
+
+    auto begin() const {
+      using I = std::decay_t<decltype(codeColumn.begin())>;
+      return dictionary_detail::DecodingIterator<std::decay_t<D>, I>(dict, codeColumn.begin());
+    }
+    auto end() const { return codeColumn.end(); }
+
+    const std::decay_t<D> & dictionary() const { return dict; }
+    const std::decay_t<C> & codes() const { return codeColumn; }
+
+    /** The codes whose dictionary entries satisfy `predicate`. */
+    template <class P> CodeMatcher matcher(P && predicate) const { return CodeMatcher(dict, std::forward<P>(predicate)); }
+  };
+
+  /**
+   * Returns a column that yields `dictionary[code]` for every code of `codes`.
+   */
+  template <class D, class C> DictColumn<D, C> dict_column(D && dictionary, C && codes) {
+    return DictColumn<D, C>(std::forward<D>(dictionary), std::forward<C>(codes));
+  }
+
+  /**
+   * Encodes the values of `iterable` with a sorted dictionary of its distinct values.
+   * Throws `std::length_error` if there are more distinct values than `Code` can represent.
+   */
+  template <class Code = uint32_t, class T> auto dict_encode(T && iterable) {
+    using Value = std::decay_t<decltype(*iterable.begin())>;
+    std::map<Value, Code> index;
+    std::vector<Code> codes;
+    for (auto &&v: iterable) {
+      auto it = index.find(v);
+      if (it == index.end()) {
+        if (index.size() > static_cast<size_t>(std::numeric_limits<Code>::max())) { throw std::length_error("too many distinct values for the code type"); }
+        it = index.emplace(v, static_cast<Code>(index.size())).first;
+      }
+      codes.push_back(it->second);
+    }
+    // renumber codes in dictionary order
+    std::vector<Value> dictionary;
+    std::vector<Code> sortedCode(index.size());
+    dictionary.reserve(index.size());
+    for (auto &entry: index) {
+      sortedCode[entry.second] = static_cast<Code>(dictionary.size());
+      dictionary.push_back(entry.first);
+    }
+    for (auto &code: codes) { code = sortedCode[code]; }
+    return dict_column(std::move(dictionary), std::move(codes));
+  }
+
+  /**
+   * The number of rows whose value satisfies `predicate`.
+   */
+  template <class D, class C, class P> size_t count_if(const DictColumn<D, C> &column, P && predicate) {
+    return dictionary_detail::countMatches(column.codes(), column.matcher(std::forward<P>(predicate)));
+  }
+
+  /**
+   * The indices of the rows whose value satisfies `predicate`.
+   */
+  template <class D, class C, class P> std::vector<size_t> matching_rows(const DictColumn<D, C> &column, P && predicate) {
+    std::vector<size_t> rows;
+    dictionary_detail::forEachMatch(column.codes(), column.matcher(std::forward<P>(predicate)), [&](size_t row){ rows.push_back(row); });
+    return rows;
+  }
+
+  /**
+   * Iterates the values that satisfy `predicate`. The column must outlive the result.
+   */
+  template <class D, class C, class P> auto filter(const DictColumn<D, C> &column, P && predicate) {
+    struct Filtered {
+      const DictColumn<D, C> * column;
+      CodeMatcher matcher;
+      auto begin() const {
+        auto code = column->codes().begin();
+        auto end = column->codes().end();
+        return dictionary_detail::FilteringIterator<std::decay_t<D>, decltype(code), decltype(end)>(column->dictionary(), matcher, code, end);
+      }
+      IterationEnd end() const { return IterationEnd(); }
+    };
+    return Filtered{&column, column.matcher(std::forward<P>(predicate))};
+  }
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+namespace easy_iterator {
+
+  namespace element_detail {
+    struct AnyField {
+      template <class T> operator T() const;
+    };
+
+    template <class T, class Seq, class = void> struct IsBraceConstructible: std::false_type { };
+    template <class T, size_t ... Idx> struct IsBraceConstructible<
+      T,
+      std::index_sequence<Idx...>,
+      std::void_t<decltype(T{(void(Idx), AnyField())...})>
+    >: std::true_type { };
+
+    /**
+     * Counts the fields of an aggregate by brace initialization. Because of brace elision, a C-array
+     * member counts as one field per array element, so aggregates with C-array members are not supported.
+     */
+    template <class T, size_t N = 0> constexpr size_t fieldCount() {
+      if constexpr (IsBraceConstructible<T, std::make_index_sequence<N + 1>>::value) {
+        return fieldCount<T, N + 1>();
+      } else {
+        return N;
+      }
+    }
+
+    template <class T, class = void> struct IsTupleLike: std::false_type { };
+    template <class T> struct IsTupleLike<T, std::void_t<decltype(std::tuple_size<T>::value)>>: std::true_type { };
+
+    /**
+     * Returns a tuple of references to the fields of an aggregate with up to 16 members.
+     */
+    template <class T> auto tieFields(T & v) {
+      constexpr size_t N = fieldCount<typename std::remove_const<T>::type>();
+      static_assert(N <= 16, "aggregates with more than 16 fields are not supported");
+      if constexpr (N == 0) {
+        return std::tuple<>();
+      } else if constexpr (N == 1) {
+        auto & [a0] = v;
+        return std::forward_as_tuple(a0);
+      } else if constexpr (N == 2) {
+        auto & [a0, a1] = v;
+        return std::forward_as_tuple(a0, a1);
+      } else if constexpr (N == 3) {
+        auto & [a0, a1, a2] = v;
+        return std::forward_as_tuple(a0, a1, a2);
+      } else if constexpr (N == 4) {
+        auto & [a0, a1, a2, a3] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3);
+      } else if constexpr (N == 5) {
+        auto & [a0, a1, a2, a3, a4] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4);
+      } else if constexpr (N == 6) {
+        auto & [a0, a1, a2, a3, a4, a5] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5);
+      } else if constexpr (N == 7) {
+        auto & [a0, a1, a2, a3, a4, a5, a6] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5, a6);
+      } else if constexpr (N == 8) {
+        auto & [a0, a1, a2, a3, a4, a5, a6, a7] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5, a6, a7);
+      } else if constexpr (N == 9) {
+        auto & [a0, a1, a2, a3, a4, a5, a6, a7, a8] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5, a6, a7, a8);
+      } else if constexpr (N == 10) {
+        auto & [a0, a1, a2, a3, a4, a5, a6, a7, a8, a9] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9);
+      } else if constexpr (N == 11) {
+        auto & [a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10);
+      } else if constexpr (N == 12) {
+        auto & [a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11);
+      } else if constexpr (N == 13) {
+        auto & [a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12);
+      } else if constexpr (N == 14) {
+        auto & [a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13);
+      } else if constexpr (N == 15) {
+        auto & [a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14);
+      } else if constexpr (N == 16) {
+        auto & [a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15] = v;
+        return std::forward_as_tuple(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15);
+      }
+    }
+
+    template <class T> decltype(auto) asTuple(T & v) {
+      if constexpr (IsTupleLike<typename std::remove_const<T>::type>::value) {
+        return v;
+      } else {
+        static_assert(std::is_aggregate<typename std::remove_const<T>::type>::value, "expected a tuple-like type or an aggregate");
+        return tieFields(v);
+      }
+    }
+
+    template <class T> using Size = std::tuple_size<typename std::decay<decltype(asTuple(std::declval<T &>()))>::type>;
+
+    template <class T, class F, size_t ... Idx> void forEach(T && t, F && f, std::index_sequence<Idx...>) {
+      using std::get;
+      (f(get<Idx>(t)), ...);
+    }
+
+    template <class A, class B, class F, size_t ... Idx> void zipEach(A && a, B && b, F && f, std::index_sequence<Idx...>) {
+      using std::get;
+      (f(get<Idx>(a), get<Idx>(b)), ...);
+    }
+  }
+
+  /**
+   * Calls `f` with every element of a `std::tuple`, `std::pair`, `std::array` or aggregate.
+   * The calls are expanded at compile time, so `f` sees the concrete type of each element.
+   * Aggregates must not have C-array members, use `std::array` instead.
+   */
+  template <class T, class F> void for_each_element(T && t, F && f) {
+    decltype(auto) elements = element_detail::asTuple(t);
+    element_detail::forEach(elements, f, std::make_index_sequence<element_detail::Size<T>::value>());
+  }
+
+  /**
+   * Calls `f(a_i, b_i)` for every pair of corresponding elements of two tuple-like objects or aggregates.
+   * As for `for_each_element()`, aggregates must not have C-array members.
+   */
+  template <class A, class B, class F> void zip_elements(A && a, B && b, F && f) {
+    static_assert(element_detail::Size<A>::value == element_detail::Size<B>::value, "zipping objects with different element counts");
+    decltype(auto) ea = element_detail::asTuple(a);
+    decltype(auto) eb = element_detail::asTuple(b);
+    element_detail::zipEach(ea, eb, f, std::make_index_sequence<element_detail::Size<A>::value>());
+  }
+
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+/**
+ * Sorting of iterables larger than memory. `external_sort()` collects the input into runs that fit
+ * the memory budget, sorts each run with all hardware threads and spills it to a temporary file as
+ * raw binary values. The result is a lazy iterable that merges the runs with large sequential reads
+ * and removes the files when it is destroyed. If the input fits into a single run, nothing is
+ * written to disk.
+ * Usage:
+ *   for (auto &v: external_sort(values, std::less<>(), size_t(1) << 30, "/mnt/scratch")) { ... }
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "iterator.h"
+
+namespace easy_iterator {
+
+  /**
+   * Thrown if a spill file cannot be created, written or read.
+   */
+  struct ExternalSortException: public std::runtime_error {
+    using std::runtime_error::runtime_error;
+  };
+
+  namespace external_sort_detail {
+
+    /**
+     * Sorts `values` by sorting one chunk per thread and merging the chunks pairwise in parallel.
+     */
+    template <class T, class Cmp> void parallelSort(std::vector<T> &values, const Cmp &cmp, unsigned threads) {
+      constexpr size_t minChunk = size_t(1) << 14;
+      threads = static_cast<unsigned>(std::min<size_t>(std::max(1u, threads), values.size() / minChunk + 1));
+      if (threads == 1) {
+        std::sort(values.begin(), values.end(), cmp);
+        return;
+      }
+      std::vector<size_t> bounds;
+      for (unsigned t = 0; t <= threads; ++t) { bounds.push_back(values.size() * t / threads); }
+      auto at = [&](size_t i){ return values.begin() + static_cast<std::ptrdiff_t>(i); };
+      std::vector<std::thread> workers;
+      for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t](){ std::sort(at(bounds[t]), at(bounds[t + 1]), cmp); });
+      }
+      for (auto &worker: workers) { worker.join(); }
+      for (size_t width = 1; width < threads; width *= 2) {
+        workers.clear();
+        for (size_t t = 0; t + width < threads; t += 2 * width) {
+          auto first = bounds[t], middle = bounds[t + width], last = bounds[std::min<size_t>(t + 2 * width, threads)];
+          workers.emplace_back([&, first, middle, last](){ std::inplace_merge(at(first), at(middle), at(last), cmp); });
+        }
+        for (auto &worker: workers) { worker.join(); }
+      }
+    }
+
+    struct FileCloser {
+      void operator()(std::FILE * file) const { std::fclose(file); }
+    };
+    using File = std::unique_ptr<std::FILE, FileCloser>;
+
+    /**
+     * Reads a spilled run sequentially in blocks of `bufferSize` values.
+     */
+    template <class T> class RunReader {
+      File file;
+      std::vector<T> buffer;
+      size_t position = 0;
+      size_t available = 0;
+
+      bool fill() {
+        available = std::fread(buffer.data(), sizeof(T), buffer.size(), file.get());
+        position = 0;
+        if (available == 0 && std::ferror(file.get())) { throw ExternalSortException("cannot read spill file"); }
+        return available > 0;
+      }
+
+    public:
+      RunReader(const std::filesystem::path &path, size_t bufferSize):file(std::fopen(path.string().c_str(), "rb")),buffer(bufferSize){
+        if (!file) { throw ExternalSortException("cannot open spill file " + path.string()); }
+        std::setvbuf(file.get(), nullptr, _IONBF, 0);
+      }
+
+      /** Loads the first value. Returns false if the run is empty. */
+      bool init() { return fill(); }
+      const T & current() const { return buffer[position]; }
+      bool advance() { return ++position < available || fill(); }
+    };
+
+    /**
+     * State shared by the copies of a merged iterable. Removes the spill files on destruction.
+     */
+    template <class T, class Cmp> class MergeState {
+      Cmp cmp;
+      std::vector<T> memory;
+      size_t memoryPosition = 0;
+      std::vector<std::filesystem::path> paths;
+      std::vector<RunReader<T>> runs;
+      std::vector<size_t> heap;
+      size_t readBufferSize;
+
+      bool heapOrder(size_t a, size_t b) const { return cmp(runs[b].current(), runs[a].current()); }
+
+    public:
+      MergeState(Cmp _cmp, std::vector<T> _memory, std::vector<std::filesystem::path> _paths, size_t _readBufferSize):
+        cmp(std::move(_cmp)),memory(std::move(_memory)),paths(std::move(_paths)),readBufferSize(_readBufferSize){ }
+
+      MergeState(const MergeState &) = delete;
+      MergeState & operator=(const MergeState &) = delete;
+
+      ~MergeState() {
+        runs.clear();
+        std::error_code error;
+        for (auto &path: paths) { std::filesystem::remove(path, error); }
+      }
+
+      bool init() {
+        if (paths.empty()) { return !memory.empty(); }
+        runs.reserve(paths.size());
+        for (auto &path: paths) {
+          runs.emplace_back(path, readBufferSize);
+          if (runs.back().init()) { heap.push_back(runs.size() - 1); }
+        }
+        auto order = [this](size_t a, size_t b){ return heapOrder(a, b); };
+        std::make_heap(heap.begin(), heap.end(), order);
+        return !heap.empty();
+      }
+
+      const T & current() const {
+        return paths.empty() ? memory[memoryPosition] : runs[heap.front()].current();
+      }
+
+      bool advance() {
+        if (paths.empty()) { return ++memoryPosition < memory.size(); }
+        auto order = [this](size_t a, size_t b){ return heapOrder(a, b); };
+        std::pop_heap(heap.begin(), heap.end(), order);
+        if (runs[heap.back()].advance()) {
+          std::push_heap(heap.begin(), heap.end(), order);
+        } else {
+          heap.pop_back();
+        }
+        return !heap.empty();
+      }
+
+      const std::vector<std::filesystem::path> & files() const { return paths; }
+    };
+
+    /**
+     * Generator for `MakeIterable` that yields the merged values.
+     */
+    template <class T, class Cmp> struct Merger: public InitializedIterable {
+      std::shared_ptr<MergeState<T, Cmp>> state;
+      explicit Merger(std::shared_ptr<MergeState<T, Cmp>> _state):state(std::move(_state)){ }
+      bool init() { return state->init(); }
+      bool advance() { return state->advance(); }
+      const T & value() { return state->current(); }
+    };
+
+    inline std::filesystem::path spillPath(const std::filesystem::path &directory, const std::string &prefix, size_t index) {
+      return directory / (prefix + "_" + std::to_string(index) + ".run");
+    }
+
+    template <class T> void spill(const std::vector<T> &values, const std::filesystem::path &path) {
+      File file(std::fopen(path.string().c_str(), "wb"));
+      if (!file) { throw ExternalSortException("cannot create spill file " + path.string()); }
+      std::setvbuf(file.get(), nullptr, _IONBF, 0);
+      if (std::fwrite(values.data(), sizeof(T), values.size(), file.get()) != values.size() || std::fflush(file.get()) != 0) {
+        throw ExternalSortException("cannot write spill file " + path.string());
+      }
+    }
+
+  }
+
+  /**
+   * The lazy iterable returned by `external_sort()`. Copies share the underlying runs, which are
+   * removed when the last copy is destroyed. Can only be iterated once.
+   */
+  template <class T, class Cmp> class ExternallySorted: public MakeIterable<external_sort_detail::Merger<T, Cmp>> {
+    std::shared_ptr<external_sort_detail::MergeState<T, Cmp>> state;
+  public:
+    explicit ExternallySorted(std::shared_ptr<external_sort_detail::MergeState<T, Cmp>> _state):
+      MakeIterable<external_sort_detail::Merger<T, Cmp>>(external_sort_detail::Merger<T, Cmp>(_state)),state(std::move(_state)){ }
+
+    /** The spill files, or none if the input fit into memory. */
+    const std::vector<std::filesystem::path> & files() const { return state->files(); }
+  };
+
+  /**
+   * Sorts the values of `iterable` by `cmp` using at most about `memoryBudget` bytes of memory.
+   * Runs hold half of the budget, so that the run and the buffers used to sort it stay within
+   * the budget. Runs that do not fit are spilled to `directory`. While merging, every spilled run
+   * reads at least 64 KiB at a time, which exceeds the budget only for a very large number of runs.
+   * The value type must be trivially copyable.
+   */
+  template <class I, class Cmp = std::less<>> auto external_sort(
+    I && iterable,
+    Cmp cmp = Cmp(),
+    size_t memoryBudget = size_t(256) << 20,
+    const std::filesystem::path &directory = std::filesystem::temp_directory_path()
+  ) {
+    using T = std::decay_t<decltype(*iterable.begin())>;
+    static_assert(std::is_trivially_copyable<T>::value, "external_sort requires trivially copyable values");
+    using namespace external_sort_detail;
+
+    // a run takes half of the budget since merging the sorted chunks of a run needs a buffer of up
+    // to half its size, and growing the run needs the old and the new storage at the same time
+    const size_t runSize = std::max<size_t>(1, memoryBudget / 2 / sizeof(T));
+    const unsigned threads = std::thread::hardware_concurrency();
+    std::string prefix = "easy_iterator_sort_" + std::to_string(std::random_device()()) + "_" + std::to_string(std::random_device()());
+    std::vector<std::filesystem::path> paths;
+    std::vector<T> run;
+    run.reserve(std::min<size_t>(runSize, size_t(1) << 20));
+
+    try {
+      for (auto &&value: iterable) {
+        if (run.size() == runSize) {
+          parallelSort(run, cmp, threads);
+          paths.push_back(spillPath(directory, prefix, paths.size()));
+          spill(run, paths.back());
+          run.clear();
+        }
+        if (run.size() == run.capacity()) { run.reserve(std::min(2 * run.capacity(), runSize)); }
+        run.push_back(value);
+      }
+      parallelSort(run, cmp, threads);
+      if (!paths.empty() && !run.empty()) {
+        paths.push_back(spillPath(directory, prefix, paths.size()));
+        spill(run, paths.back());
+        std::vector<T>().swap(run);
+      }
+    } catch (...) {
+      std::error_code error;
+      for (auto &path: paths) { std::filesystem::remove(path, error); }
+      throw;
+    }
+
+    // every run reads with an equal share of the budget, but at least 64 KiB at a time
+    size_t readBufferSize = paths.empty() ? 0 : std::max(memoryBudget / paths.size(), size_t(64) << 10) / sizeof(T) + 1;
+    return ExternallySorted<T, Cmp>(std::make_shared<MergeState<T, Cmp>>(std::move(cmp), std::move(run), std::move(paths), readBufferSize));
+  }
+
+}
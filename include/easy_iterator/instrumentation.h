@@ -0,0 +1,346 @@
+#pragma once
+
+/**
+ * Lightweight loop instrumentation. `instrumented("name", iterable)` counts the visited elements
+ * and the total time spent in the loop and reports them to a global registry when the loop ends.
+ * Optionally every Nth element's latency is sampled into a log-linear histogram.
+ *
+ * Instrumentation is disabled by default and `instrumented()` then returns the iterable itself.
+ * Define `EASY_ITERATOR_INSTRUMENTATION=1` to enable it globally, or pass the template flag
+ * explicitly, e.g. `instrumented<true>("name", iterable)`.
+ * While a trace is running (see `trace.h`), enabled loops also record begin and end events.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "trace.h"
+
+#ifndef EASY_ITERATOR_INSTRUMENTATION
+#define EASY_ITERATOR_INSTRUMENTATION 0
+#endif
+
+namespace easy_iterator {
+
+  namespace instrumentation {
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * A histogram with 8 linear sub-buckets per power of two, covering all `uint64_t` values with a
+     * relative error of at most 12.5%. Recording is lock-free and may happen from multiple threads.
+     */
+    class Histogram {
+    public:
+      static constexpr unsigned subBucketBits = 3;
+      static constexpr unsigned subBuckets = 1 << subBucketBits;
+      static constexpr size_t bucketCount = (64 - subBucketBits + 1) * subBuckets;
+
+      static unsigned highestBit(uint64_t value) {
+#if defined(__GNUC__)
+        return 63 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+        unsigned bit = 0;
+        while (value >>= 1) { ++bit; }
+        return bit;
+#endif
+      }
+
+      static size_t bucketIndex(uint64_t value) {
+        if (value < subBuckets) { return static_cast<size_t>(value); }
+        unsigned exponent = highestBit(value);
+        auto sub = (value >> (exponent - subBucketBits)) & (subBuckets - 1);
+        return (exponent - subBucketBits + 1) * subBuckets + static_cast<size_t>(sub);
+      }
+
+      static uint64_t bucketLowerBound(size_t index) {
+        if (index < subBuckets) { return index; }
+        unsigned exponent = static_cast<unsigned>(index / subBuckets) + subBucketBits - 1;
+        return (subBuckets + index % subBuckets) << (exponent - subBucketBits);
+      }
+
+      void record(uint64_t value) {
+        counts[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        valueSum.fetch_add(value, std::memory_order_relaxed);
+      }
+
+      /**
+       * Returns the sum of all recorded values.
+       */
+      uint64_t sum() const { return valueSum.load(std::memory_order_relaxed); }
+
+      uint64_t count() const {
+        uint64_t total = 0;
+        for (auto &c: counts) { total += c.load(std::memory_order_relaxed); }
+        return total;
+      }
+
+      uint64_t bucket(size_t index) const { return counts[index].load(std::memory_order_relaxed); }
+
+      /**
+       * Returns the lower bound of the bucket containing the quantile `q` in `[0, 1]`, or 0 if empty.
+       */
+      uint64_t percentile(double q) const {
+        auto n = count();
+        if (n == 0) { return 0; }
+        auto rank = static_cast<uint64_t>(q * static_cast<double>(n - 1));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucketCount; ++i) {
+          seen += bucket(i);
+          if (seen > rank) { return bucketLowerBound(i); }
+        }
+        return bucketLowerBound(bucketCount - 1);
+      }
+
+      void reset() {
+        for (auto &c: counts) { c.store(0, std::memory_order_relaxed); }
+        valueSum.store(0, std::memory_order_relaxed);
+      }
+
+    private:
+      std::array<std::atomic<uint64_t>, bucketCount> counts{};
+      std::atomic<uint64_t> valueSum{0};
+    };
+
+    /**
+     * Accumulated statistics of a single instrumented loop.
+     * Trace events refer to `name`, so stats must outlive a running trace.
+     */
+    struct LoopStats {
+      const std::string name;
+      std::atomic<uint64_t> invocations{0};
+      std::atomic<uint64_t> elements{0};
+      std::atomic<uint64_t> totalNs{0};
+      Histogram latencyNs;
+
+      explicit LoopStats(std::string _name):name(std::move(_name)){ }
+
+      void reset() {
+        invocations.store(0, std::memory_order_relaxed);
+        elements.store(0, std::memory_order_relaxed);
+        totalNs.store(0, std::memory_order_relaxed);
+        latencyNs.reset();
+      }
+    };
+
+    /**
+     * Owns the statistics of all instrumented loops. Entries are never removed, so references
+     * returned by `get()` stay valid for the lifetime of the registry.
+     */
+    class Registry {
+    public:
+      static Registry & global() {
+        static Registry registry;
+        return registry;
+      }
+
+      LoopStats & get(const std::string &name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &stats = loops[name];
+        if (!stats) { stats = std::make_unique<LoopStats>(name); }
+        return *stats;
+      }
+
+      /**
+       * Calls `f(const LoopStats &)` for every registered loop in order of their names.
+       */
+      template <class F> void forEach(F && f) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &loop: loops) { f(static_cast<const LoopStats &>(*loop.second)); }
+      }
+
+      void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &loop: loops) { loop.second->reset(); }
+      }
+
+      /**
+       * Writes a human-readable table of all loops, sorted by total time.
+       */
+      void dump(std::ostream &stream) const {
+        std::vector<const LoopStats *> sorted;
+        forEach([&](const LoopStats &stats){ sorted.push_back(&stats); });
+        std::sort(sorted.begin(), sorted.end(), [](auto a, auto b){ return a->totalNs.load() > b->totalNs.load(); });
+        stream << "loop\tinvocations\telements\ttotal [ns]\tp50 [ns]\tp99 [ns]\n";
+        for (auto stats: sorted) {
+          stream << stats->name << '\t' << stats->invocations.load() << '\t' << stats->elements.load() << '\t'
+            << stats->totalNs.load() << '\t' << stats->latencyNs.percentile(0.5) << '\t' << stats->latencyNs.percentile(0.99) << '\n';
+        }
+      }
+
+      /**
+       * Writes all loops in the Prometheus text exposition format.
+       */
+      void scrape(std::ostream &stream) const {
+        stream << "# TYPE easy_iterator_loop_invocations_total counter\n";
+        forEach([&](const LoopStats &s){ stream << "easy_iterator_loop_invocations_total{loop=\"" << escapeLabel(s.name) << "\"} " << s.invocations.load() << '\n'; });
+        stream << "# TYPE easy_iterator_loop_elements_total counter\n";
+        forEach([&](const LoopStats &s){ stream << "easy_iterator_loop_elements_total{loop=\"" << escapeLabel(s.name) << "\"} " << s.elements.load() << '\n'; });
+        stream << "# TYPE easy_iterator_loop_seconds_total counter\n";
+        forEach([&](const LoopStats &s){ stream << "easy_iterator_loop_seconds_total{loop=\"" << escapeLabel(s.name) << "\"} " << s.totalNs.load() * 1e-9 << '\n'; });
+        stream << "# TYPE easy_iterator_loop_element_latency_seconds histogram\n";
+        forEach([&](const LoopStats &s){
+          uint64_t cumulative = 0;
+          for (size_t i = 0; i < Histogram::bucketCount; ++i) {
+            auto c = s.latencyNs.bucket(i);
+            if (c == 0) { continue; }
+            cumulative += c;
+            auto upper = i + 1 < Histogram::bucketCount ? Histogram::bucketLowerBound(i + 1) : Histogram::bucketLowerBound(i);
+            stream << "easy_iterator_loop_element_latency_seconds_bucket{loop=\"" << escapeLabel(s.name) << "\",le=\"" << upper * 1e-9 << "\"} " << cumulative << '\n';
+          }
+          stream << "easy_iterator_loop_element_latency_seconds_bucket{loop=\"" << escapeLabel(s.name) << "\",le=\"+Inf\"} " << cumulative << '\n';
+          stream << "easy_iterator_loop_element_latency_seconds_sum{loop=\"" << escapeLabel(s.name) << "\"} " << s.latencyNs.sum() * 1e-9 << '\n';
+          stream << "easy_iterator_loop_element_latency_seconds_count{loop=\"" << escapeLabel(s.name) << "\"} " << cumulative << '\n';
+        });
+      }
+
+    private:
+      /**
+       * Escapes a label value of the Prometheus text format.
+       */
+      static std::string escapeLabel(const std::string &value) {
+        std::string escaped;
+        for (auto c: value) {
+          if (c == '\n') { escaped += "\\n"; continue; }
+          if (c == '"' || c == '\\') { escaped += '\\'; }
+          escaped += c;
+        }
+        return escaped;
+      }
+
+      mutable std::mutex mutex;
+      std::map<std::string, std::unique_ptr<LoopStats>> loops;
+    };
+
+  }
+
+  namespace instrumentation_detail {
+
+    /**
+     * Per-invocation counters, reported to the `LoopStats` when the loop ends.
+     */
+    struct Counters {
+      instrumentation::LoopStats * stats;
+      uint64_t sampleEvery;
+      uint64_t elements = 0;
+      uint64_t untilSample;
+      bool started = false;
+      bool sampling = false;
+      instrumentation::Clock::time_point start, sampleStart;
+
+      Counters(instrumentation::LoopStats &_stats, uint64_t _sampleEvery):stats(&_stats),sampleEvery(_sampleEvery),untilSample(_sampleEvery){ }
+
+      void visit() {
+        ++elements;
+        if (sampleEvery == 0) { return; }
+        if (sampling) { finishSample(); }
+        if (--untilSample == 0) {
+          untilSample = sampleEvery;
+          sampling = true;
+          sampleStart = instrumentation::Clock::now();
+        }
+      }
+
+      void finishSample() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(instrumentation::Clock::now() - sampleStart).count();
+        stats->latencyNs.record(static_cast<uint64_t>(ns));
+        sampling = false;
+      }
+
+      void begin() {
+        started = true;
+        trace::begin(stats->name.c_str());
+        start = instrumentation::Clock::now();
+      }
+
+      ~Counters() {
+        if (!started) { return; }
+        trace::end(stats->name.c_str());
+        if (sampling) { finishSample(); }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(instrumentation::Clock::now() - start).count();
+        stats->invocations.fetch_add(1, std::memory_order_relaxed);
+        stats->elements.fetch_add(elements, std::memory_order_relaxed);
+        stats->totalNs.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+      }
+    };
+
+    template <class I> class InstrumentedIterator {
+      I iterator;
+      Counters * counters;
+    public:
+      InstrumentedIterator(I _iterator, Counters &_counters):iterator(std::move(_iterator)),counters(&_counters){ }
+      decltype(auto) operator*() { counters->visit(); return *iterator; }
+      InstrumentedIterator & operator++() { ++iterator; return *this; }
+      template <class E> bool operator!=(const E &end) const { return iterator != end; }
+      template <class E> bool operator==(const E &end) const { return !(iterator != end); }
+    };
+
+  }
+
+  /**
+   * Iterable returned by an enabled `instrumented()`. Reports to its `LoopStats` on destruction.
+   */
+  template <class T> class InstrumentedIterable {
+    T iterable;
+    instrumentation_detail::Counters counters;
+  public:
+    InstrumentedIterable(T && _iterable, instrumentation::LoopStats &stats, uint64_t sampleEvery):
+      iterable(std::forward<T>(_iterable)),counters(stats, sampleEvery){ }
+    InstrumentedIterable(const InstrumentedIterable &) = delete;
+    InstrumentedIterable & operator=(const InstrumentedIterable &) = delete;
+
+    auto begin() {
+      counters.begin();
+      using I = std::decay_t<decltype(iterable.begin())>;
+      return instrumentation_detail::InstrumentedIterator<I>(iterable.begin(), counters);
+    }
+    decltype(auto) end() { return iterable.end(); }
+  };
+
+  /**
+   * Instruments the iteration over `iterable`. Every iteration adds one invocation, the number of
+   * visited elements and the elapsed time to `stats`. If `sampleEvery` is positive, the latency
+   * of every `sampleEvery`-th element is recorded in `stats.latencyNs`.
+   * When disabled, `iterable` is returned unchanged (by reference for lvalues).
+   */
+  template <bool Enabled = EASY_ITERATOR_INSTRUMENTATION, class T> std::conditional_t<Enabled, InstrumentedIterable<T>, T> instrumented(
+    instrumentation::LoopStats &stats, T && iterable, uint64_t sampleEvery = 0
+  ) {
+    if constexpr (Enabled) {
+      return InstrumentedIterable<T>(std::forward<T>(iterable), stats, sampleEvery);
+    } else {
+      (void)stats;
+      (void)sampleEvery;
+      return std::forward<T>(iterable);
+    }
+  }
+
+  /**
+   * Instruments the iteration over `iterable` under `name` in the global registry.
+   * Each call looks up `name` once; for loops that are entered very frequently, cache the
+   * result of `instrumentation::Registry::global().get(name)` and use the overload above.
+   */
+  template <bool Enabled = EASY_ITERATOR_INSTRUMENTATION, class T> std::conditional_t<Enabled, InstrumentedIterable<T>, T> instrumented(
+    const char * name, T && iterable, uint64_t sampleEvery = 0
+  ) {
+    if constexpr (Enabled) {
+      return InstrumentedIterable<T>(std::forward<T>(iterable), instrumentation::Registry::global().get(name), sampleEvery);
+    } else {
+      (void)name;
+      (void)sampleEvery;
+      return std::forward<T>(iterable);
+    }
+  }
+
+}
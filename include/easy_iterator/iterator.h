@@ -0,0 +1,378 @@
+#pragma once
+
+#include <iterator>
+#include <exception>
+#include <utility>
+#include <type_traits>
+
+namespace easy_iterator {
+
+  /**
+   * The end state for self-contained iterators.
+   */
+  struct IterationEnd {
+    const IterationEnd & operator*()const{ return *this; }
+  };
+  
+  /**
+   * Helper functions for comparing iterators.
+   */
+  namespace compare {
+
+    struct ByValue {
+      template <class T> bool operator()(const T &a, const T &b)const{ return a == b; }
+    };
+
+    struct ByAddress {
+      template <class T> bool operator()(const  T &a, const  T &b)const{ return &a == &b; }
+    };
+
+    struct Never {
+      template <class A, class B> bool operator()(const A &, const B &)const{ return false; }
+    };
+  }
+
+  /**
+   * Helper functions for incrementing iterators.
+   */
+  namespace increment {
+    template <int A> struct ByValue {
+      template <class T> void operator () (T &v) const { v = v + A; }
+    };
+    
+    template <typename T, typename M, M Method> struct ByMemberCall {
+      using R = decltype((std::declval<T &>().*Method)());
+      R operator () (T &v) const { return (v.*Method)(); }
+    };
+
+  }
+
+  /**
+   * Helper functions for dereferencing iterators.
+   */
+  namespace dereference {
+    struct ByValue {
+      template <class T> T operator()(T & v) const { return v; }
+    };
+    
+    struct ByConstValueReference {
+      template <class T> const T & operator()(T & v) const { return v; }
+    };
+    
+    struct ByValueReference {
+      template <class T> T & operator()(T & v) const { return v; }
+    };
+    
+    struct ByValueDereference {
+      template <class T> auto & operator()(T & v) const { return *v; }
+    };
+
+    template <typename T, typename M, M Method> struct ByMemberCall {
+      using R = decltype((std::declval<T &>().*Method)());
+      R operator () (T &v) const { return (v.*Method)(); }
+    };
+    
+  }
+
+  /**
+   * Exception when dereferencing an undefined iterator value.
+   */
+  struct UndefinedIteratorException: public std::exception {
+    const char * what()const noexcept override{ return "attempt to dereference an undefined iterator"; }
+  };
+  
+  namespace iterator_detail{
+    struct WithState {
+      constexpr static bool hasState = true;
+      bool state = true;
+    };
+    template <class Owner> struct WithoutState {
+      constexpr static bool hasState = false;
+    };
+    
+    template <class F, class T> inline constexpr bool needsState = !std::is_same<void, decltype(std::declval<F>()(std::declval<T&>()))>::value;
+
+    enum class Storage { Member, EmptyBase, Stateless };
+
+    template <class T> constexpr Storage storageFor() {
+      if constexpr (!std::is_empty<T>::value) {
+        return Storage::Member;
+      } else if constexpr (std::is_trivially_default_constructible<T>::value) {
+        return Storage::Stateless;
+      } else if constexpr (!std::is_final<T>::value) {
+        return Storage::EmptyBase;
+      } else {
+        return Storage::Member;
+      }
+    }
+
+    /**
+     * Holds a functional of type `T` for the iterator `Owner`. Empty functionals do not add to the size
+     * of the iterator: trivially constructible ones are recreated on access, others are stored as a base class.
+     * `Owner` and `Tag` keep the empty base classes of nested iterators distinct, so they may share an address.
+     */
+    template <
+      class Owner,
+      size_t Tag,
+      class T,
+      Storage S = storageFor<T>()
+    > class CompressedMember {
+      T member;
+    public:
+      template <class A> explicit CompressedMember(A && a):member(std::forward<A>(a)){ }
+      T & get(){ return member; }
+      const T & get()const{ return member; }
+    };
+
+    template <class Owner, size_t Tag, class T> class CompressedMember<Owner, Tag, T, Storage::EmptyBase>: private T {
+    public:
+      template <class A> explicit CompressedMember(A && a):T(std::forward<A>(a)){ }
+      T & get(){ return *this; }
+      const T & get()const{ return *this; }
+    };
+
+    template <class Owner, size_t Tag, class T> class CompressedMember<Owner, Tag, T, Storage::Stateless> {
+    public:
+      template <class A> explicit CompressedMember(A &&){ }
+      T get()const{ return T(); }
+    };
+  }
+
+  /**
+   * Base class for simple iterators. Takes several template parameters.
+   * Implementations must define `operator++()` to update the value of `value`.
+   * @param `T` - The data type held by the iterator
+   * @param `D` - A functional that dereferences the data. Determines the value type of the iterator.
+   * @param `C` - A function that compares two values of type `T`. Used to determine if two iterators are equal.
+   */
+  template <
+    class T,
+    typename D = dereference::ByValueReference,
+    typename C = compare::ByValue
+  > class IteratorPrototype:
+    public std::iterator<
+      std::input_iterator_tag,
+      typename std::decay<decltype(std::declval<D>()(std::declval<T&>()))>::type
+    >,
+    private iterator_detail::CompressedMember<IteratorPrototype<T,D,C>, 0, D>,
+    private iterator_detail::CompressedMember<IteratorPrototype<T,D,C>, 1, C>
+  {
+  protected:
+    using DereferencerMember = iterator_detail::CompressedMember<IteratorPrototype, 0, D>;
+    using CompareMember = iterator_detail::CompressedMember<IteratorPrototype, 1, C>;
+    /**
+     * Access to the functionals, which are not data members so that empty ones take no space.
+     * `dereferencer()` and `compare()` return the functional, `dereferencer(value)` and
+     * `compare(a, b)` call it. The functionals can not be reassigned.
+     */
+    decltype(auto) dereferencer(){ return DereferencerMember::get(); }
+    template <class ... Args> decltype(auto) dereferencer(Args && ... args){ return DereferencerMember::get()(std::forward<Args>(args)...); }
+    decltype(auto) compare()const{ return CompareMember::get(); }
+    template <class ... Args> decltype(auto) compare(Args && ... args)const{ return CompareMember::get()(std::forward<Args>(args)...); }
+  public:
+    T value;
+    using DereferencedType = decltype(std::declval<D &>()(std::declval<T &>()));
+    
+    IteratorPrototype() = delete;
+    template <class F, class AD = D, class AC = C> explicit IteratorPrototype(
+      F && first,
+      AD && _dereferencer = D(),
+      AC && _compare = C()
+    ):DereferencerMember(std::forward<AD>(_dereferencer)),CompareMember(std::forward<AC>(_compare)), value(std::forward<F>(first)) { }
+    
+    DereferencedType operator *() { return dereferencer()(value); }
+    auto * operator->()const{ return &**this; }
+    template <typename ... Args> bool operator==(const IteratorPrototype<Args...> &other)const{
+      return compare()(value, other.value);
+    }
+    template <typename ... Args> bool operator!=(const IteratorPrototype<Args...> &other)const{
+      return !operator==(other);
+    }
+  };
+  
+  template<
+    class T
+  > IteratorPrototype(const T &) -> IteratorPrototype<T>;
+
+  template<
+    class T,
+    typename D
+  > IteratorPrototype(const T &, const D &) -> IteratorPrototype<T, D>;
+
+  template<
+    class T,
+    typename D,
+    typename C
+  > IteratorPrototype(const T &, const D &, const C &) -> IteratorPrototype<T, D, C>;
+
+  /**
+   * IteratorPrototype where advance is defined by the functional held by `F`.
+   */
+  template <
+    class T,
+    typename F = increment::ByValue<1>,
+    typename D = dereference::ByValueReference,
+    typename C = compare::ByValue
+  > class Iterator final :
+    public IteratorPrototype<T,D,C>,
+    public std::conditional<iterator_detail::needsState<F,T>,iterator_detail::WithState, iterator_detail::WithoutState<Iterator<T,F,D,C>>>::type,
+    private iterator_detail::CompressedMember<Iterator<T,F,D,C>, 2, F>
+  {
+  protected:
+    using Base = IteratorPrototype<T,D,C>;
+    using CallbackMember = iterator_detail::CompressedMember<Iterator, 2, F>;
+    decltype(auto) callback(){ return CallbackMember::get(); }
+  public:
+    template <
+      typename TT,
+      typename TF = F,
+      typename TD = D,
+      typename TC = C
+    > explicit Iterator(
+      TT && begin,
+      TF && _callback = F(),
+      TD && _dereferencer = D(),
+      TC && _compare = C()
+    ):IteratorPrototype<T,D,C>(std::forward<TT>(begin), std::forward<TD>(_dereferencer), std::forward<TC>(_compare)), CallbackMember(std::forward<TF>(_callback)){ }
+    Iterator &operator++(){
+      if constexpr (Iterator::hasState) {
+        if (Iterator::state) {
+          Iterator::state = callback()(Base::value);
+        }
+      } else {
+        callback()(Base::value);
+      }
+      return *this;
+    }
+    typename Base::DereferencedType operator *() {
+      if constexpr (Iterator::hasState) {
+        if(!Iterator::state) {
+          throw UndefinedIteratorException();
+        }
+      }
+      return Base::dereferencer()(Base::value);
+    }
+    using Base::operator==;
+    using Base::operator!=;
+    bool operator==(const IterationEnd &other)const{ return !operator!=(other); }
+    bool operator!=(const IterationEnd &)const{
+      if constexpr (Iterator::hasState) {
+        return Iterator::state;
+      } else {
+        return true;
+      }
+    }
+    explicit operator bool() const {
+      if constexpr (Iterator::hasState) {
+        return Iterator::state;
+      } else {
+        return true;
+      }
+    }
+  };
+
+  template<
+    class T
+  > Iterator(const T &) -> Iterator<T>;
+
+  template<
+    class T,
+    typename F
+  > Iterator(const T &, const F &) -> Iterator<T, F>;
+
+  template<
+    class T,
+    typename F,
+    typename D
+  > Iterator(const T &, const F &, const D &) -> Iterator<T, F, D>;
+
+  template<
+    class T,
+    typename F,
+    typename D,
+    typename C
+  > Iterator(const T &, const F &, const D &, const C &) -> Iterator<T, F, D, C>;
+
+  template<
+  class T,
+  typename F = increment::ByValue<1>,
+  typename D = dereference::ByValueReference,
+  typename C = compare::ByValue
+  > Iterator<T,F,D,C> makeIterator(T &&t, F f = F(), D && d = D(), C && c = C()){
+    return Iterator<T,F,D,C>(t,f,d,c);
+  }
+
+  /**
+   * Iterates by incrementing a pointer value. Returns the dereferenced pointer.
+   */
+  template<class T, class A = increment::ByValue<1>> using ReferenceIterator = Iterator<
+    T*,
+    A,
+    dereference::ByValueDereference
+  >;
+
+  /**
+   * Helper class for `wrap()`.
+   */
+  template <class IB, class IE = IB> struct WrappedIterator {
+    mutable IB beginIterator;
+    mutable IE endIterator;
+    IB && begin() const { return std::move(beginIterator); }
+    IE && end() const { return std::move(endIterator); }
+    WrappedIterator(IB && begin, IE && end):beginIterator(std::move(begin)),endIterator(std::move(end)){ }
+  };
+
+  /**
+   * Wraps two iterators into a single-use container with begin/end methods to match the C++ iterator convention.
+   */
+  template <class IB, class IE> auto wrap(IB && a, IE && b) {
+    return WrappedIterator<IB, IE>(std::forward<IB>(a), std::forward<IE>(b));
+  }
+
+  /**
+   * Wrappes the `rbegin` and `rend` iterators.
+   */
+  template <class T> auto reverse(T & v) {
+    return wrap(v.rbegin(), v.rend());
+  }
+
+  /**
+   * When used as a base class for a iterator type, `MakeIterable` will call the `bool init()` member before iteration.
+   * If `init()` returns false, the iterator is empty.
+   */
+  struct InitializedIterable {
+  };
+  
+  /**
+   * Take a class `T` with that defines the methods `T::advance()` and `O T::value()` for any type `O`
+   * and wraps it into a single-use iterable class. The return value of `T::advance()` is used to indicate the
+   * state of the iterator.
+   */
+  template <class T> struct MakeIterable {
+    mutable Iterator<
+      T,
+      increment::ByMemberCall<T, decltype(&T::advance), &T::advance>,
+      dereference::ByMemberCall<T, decltype(&T::value), &T::value>,
+      compare::ByValue
+    > start;
+    
+    auto && begin()const{
+      if constexpr (std::is_base_of<InitializedIterable, T>::value) {
+        start.state = start.value.init();
+      }
+      return std::move(start);
+    }
+    auto end()const{ return IterationEnd(); }
+    
+    explicit MakeIterable(T && value):start(std::move(value)){ }
+    template <typename ... Args> explicit MakeIterable(Args && ... args):start(T(std::forward<Args>(args)...)){ }
+  };
+  
+  /**
+   * Iterates over the dereferenced values between `begin` and `end`.
+   */
+  template <class T, class I = increment::ByValue<1>> auto valuesBetween(T * begin, T * end) {
+    return wrap(ReferenceIterator<T, I>(begin), Iterator(end));
+  }
+
+}
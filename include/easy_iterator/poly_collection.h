@@ -0,0 +1,108 @@
+#pragma once
+
+/**
+ * A polymorphic collection that stores the objects of every registered derived type in a
+ * contiguous segment of its own. `for_each` visits one segment after another and passes the
+ * objects with their concrete type, so calls to virtual methods of `final` types are
+ * devirtualized and the remaining indirect branches see runs of a single type.
+ * Usage:
+ *   PolyCollection<Plugin, Resize, Blur, Sharpen> plugins;
+ *   plugins.insert(Blur(3));
+ *   for_each(plugins, [&](auto &plugin){ plugin.process(image); });
+ */
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace easy_iterator {
+
+  namespace poly_collection_detail {
+
+    template <class T, class ... Ts> struct IsOneOf: std::disjunction<std::is_same<T, Ts>...> { };
+
+  }
+
+  /**
+   * Stores objects derived from `Base`. Objects of the types `Derived...` are kept by value in one
+   * vector per type, objects of other types are kept on the heap in a single fallback segment.
+   * Inserting may move the objects of the same type.
+   */
+  template <class Base, class ... Derived> class PolyCollection {
+    static_assert(std::conjunction<std::is_base_of<Base, Derived>...>::value, "registered types must derive from the base");
+
+    std::tuple<std::vector<Derived>...> registered;
+    std::vector<std::unique_ptr<Base>> others;
+
+  public:
+    /**
+     * Constructs an object of type `T` from `args`.
+     */
+    template <class T, class ... Args> T & emplace(Args && ... args) {
+      static_assert(std::is_base_of<Base, T>::value, "type must derive from the base");
+      if constexpr (poly_collection_detail::IsOneOf<T, Derived...>::value) {
+        return std::get<std::vector<T>>(registered).emplace_back(std::forward<Args>(args)...);
+      } else {
+        auto object = std::make_unique<T>(std::forward<Args>(args)...);
+        auto &result = *object;
+        others.push_back(std::move(object));
+        return result;
+      }
+    }
+
+    template <class T> auto & insert(T && object) { return emplace<std::decay_t<T>>(std::forward<T>(object)); }
+
+    /**
+     * The segment of the registered type `T`.
+     */
+    template <class T> std::vector<T> & segment() { return std::get<std::vector<T>>(registered); }
+    template <class T> const std::vector<T> & segment() const { return std::get<std::vector<T>>(registered); }
+
+    /**
+     * The objects whose types are not registered.
+     */
+    const std::vector<std::unique_ptr<Base>> & unregistered() const { return others; }
+
+    size_t size() const {
+      return std::apply([](auto &... segments){ return (segments.size() + ... + size_t(0)); }, registered) + others.size();
+    }
+    bool empty() const { return size() == 0; }
+
+    void clear() {
+      std::apply([](auto &... segments){ (segments.clear(), ...); }, registered);
+      others.clear();
+    }
+
+    /**
+     * Calls `f` for every object, segment by segment. Objects of registered types are passed with
+     * their concrete type, all others as `Base`.
+     */
+    template <class F> void for_each(F && f) {
+      std::apply([&](auto &... segments){ (forEachIn(segments, f), ...); }, registered);
+      for (auto &object: others) { f(*object); }
+    }
+    template <class F> void for_each(F && f) const {
+      std::apply([&](auto &... segments){ (forEachIn(segments, f), ...); }, registered);
+      for (auto &object: others) { f(static_cast<const Base &>(*object)); }
+    }
+
+  private:
+    template <class S, class F> static void forEachIn(S &segment, F &f) {
+      for (auto it = segment.begin(), end = segment.end(); it != end; ++it) { f(*it); }
+    }
+  };
+
+  /**
+   * Calls `f` for every object of `collection`, segment by segment.
+   */
+  template <class Base, class ... Derived, class F> void for_each(PolyCollection<Base, Derived...> &collection, F && f) {
+    collection.for_each(std::forward<F>(f));
+  }
+  template <class Base, class ... Derived, class F> void for_each(const PolyCollection<Base, Derived...> &collection, F && f) {
+    collection.for_each(std::forward<F>(f));
+  }
+
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+/**
+ * Progress reporting for long iterations. Each adaptor counts visited elements locally and adds
+ * them to a shared atomic only every `publishEvery` elements, so the hot loop only increments a
+ * local counter. On publishing, the callback is invoked if at least `interval` has passed since
+ * the last report. Several workers can share one `Progress`, e.g. one adaptor per parallel chunk.
+ * Usage:
+ *   for (auto &v: with_progress(values, [](const ProgressInfo &p){ std::cout << p.fraction() << std::endl; })) { ... }
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace easy_iterator {
+
+  /**
+   * A snapshot of the progress passed to the callback.
+   */
+  struct ProgressInfo {
+    uint64_t done;
+    /** Total number of elements, or 0 if unknown. */
+    uint64_t total;
+    double elapsedSeconds;
+    double itemsPerSecond;
+    /** Estimated remaining seconds, or a negative value if the total is unknown. */
+    double etaSeconds;
+    /** True for the final report. */
+    bool finished;
+
+    double fraction() const { return total ? double(done) / double(total) : 0; }
+  };
+
+  /**
+   * Shared progress state. Thread safe; the callback is never called concurrently.
+   */
+  class Progress {
+  public:
+    using Callback = std::function<void(const ProgressInfo &)>;
+    using Clock = std::chrono::steady_clock;
+
+    explicit Progress(
+      Callback _callback, Clock::duration _interval = std::chrono::seconds(1), uint64_t _total = 0, uint64_t _publishEvery = 4096
+    ):publishEvery(_publishEvery > 0 ? _publishEvery : 1),callback(std::move(_callback)),interval(_interval),total(_total),start(Clock::now()){
+      lastReport.store(0, std::memory_order_relaxed);
+    }
+
+    Progress(const Progress &) = delete;
+    Progress & operator=(const Progress &) = delete;
+
+    /**
+     * Adds `count` elements. Reports if the interval has passed and no other thread is reporting.
+     */
+    void publish(uint64_t count) {
+      done.fetch_add(count, std::memory_order_relaxed);
+      auto now = elapsedNs();
+      if (now - lastReport.load(std::memory_order_relaxed) < intervalNs()) { return; }
+      if (reporting.exchange(true, std::memory_order_acquire)) { return; }
+      if (now - lastReport.load(std::memory_order_relaxed) >= intervalNs()) {
+        lastReport.store(now, std::memory_order_relaxed);
+        callback(info(now, false));
+      }
+      reporting.store(false, std::memory_order_release);
+    }
+
+    /**
+     * Calls the callback with the final state. Should be called once after all workers have finished.
+     */
+    void finish() {
+      // another thread may be inside the callback, which can take long, so do not burn its core
+      while (reporting.exchange(true, std::memory_order_acquire)) { std::this_thread::yield(); }
+      callback(info(elapsedNs(), true));
+      reporting.store(false, std::memory_order_release);
+    }
+
+    uint64_t count() const { return done.load(std::memory_order_relaxed); }
+
+    const uint64_t publishEvery;
+
+  private:
+    int64_t elapsedNs() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(); }
+    int64_t intervalNs() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count(); }
+
+    ProgressInfo info(int64_t ns, bool finished) const {
+      auto n = count();
+      double seconds = double(ns) * 1e-9;
+      double rate = seconds > 0 ? double(n) / seconds : 0;
+      double eta = -1;
+      if (total) { eta = n >= total ? 0 : (rate > 0 ? double(total - n) / rate : -1); }
+      return ProgressInfo{n, total, seconds, rate, eta, finished};
+    }
+
+    Callback callback;
+    Clock::duration interval;
+    uint64_t total;
+    Clock::time_point start;
+    std::atomic<uint64_t> done{0};
+    std::atomic<int64_t> lastReport;
+    std::atomic<bool> reporting{false};
+  };
+
+  namespace progress_detail {
+
+    /**
+     * Per-adaptor counter that publishes to the shared `Progress` in batches.
+     */
+    struct LocalCounter {
+      Progress * progress;
+      uint64_t pending = 0;
+
+      explicit LocalCounter(Progress &_progress):progress(&_progress){ }
+
+      void visit() {
+        if (++pending == progress->publishEvery) {
+          progress->publish(pending);
+          pending = 0;
+        }
+      }
+
+      ~LocalCounter() { if (pending) { progress->publish(pending); } }
+    };
+
+    template <class I> class CountingIterator {
+      I iterator;
+      LocalCounter * counter;
+    public:
+      CountingIterator(I _iterator, LocalCounter &_counter):iterator(std::move(_iterator)),counter(&_counter){ }
+      decltype(auto) operator*() { counter->visit(); return *iterator; }
+      CountingIterator & operator++() { ++iterator; return *this; }
+      template <class E> bool operator!=(const E &end) const { return iterator != end; }
+      template <class E> bool operator==(const E &end) const { return !(iterator != end); }
+    };
+
+    template <class T, class = void> struct HasSize: std::false_type { };
+    template <class T> struct HasSize<T, std::void_t<decltype(std::size(std::declval<T &>()))>>: std::true_type { };
+
+    template <class T> uint64_t sizeOf(T &iterable) {
+      if constexpr (HasSize<T>::value) { return static_cast<uint64_t>(std::size(iterable)); }
+      else { (void)iterable; return 0; }
+    }
+
+    /**
+     * Holds the `Progress` for adaptors that own it and reports the final state on destruction.
+     */
+    struct OwnedProgress {
+      Progress progress;
+      template <class ... Args> explicit OwnedProgress(Args && ... args):progress(std::forward<Args>(args)...){ }
+      ~OwnedProgress() { progress.finish(); }
+    };
+
+  }
+
+  /**
+   * Iterable returned by `with_progress()`.
+   */
+  template <class T, class P> class ProgressIterable {
+    T iterable;
+    P owner;
+    progress_detail::LocalCounter counter;
+
+    static Progress & progressOf(Progress &p) { return p; }
+    static Progress & progressOf(progress_detail::OwnedProgress &p) { return p.progress; }
+
+  public:
+    template <class ... Args> ProgressIterable(T && _iterable, Args && ... args):
+      iterable(std::forward<T>(_iterable)),owner(std::forward<Args>(args)...),counter(progressOf(owner)){ }
+    ProgressIterable(const ProgressIterable &) = delete;
+    ProgressIterable & operator=(const ProgressIterable &) = delete;
+
+    auto begin() {
+      using I = std::decay_t<decltype(iterable.begin())>;
+      return progress_detail::CountingIterator<I>(iterable.begin(), counter);
+    }
+    decltype(auto) end() { return iterable.end(); }
+  };
+
+  /**
+   * Iterates over `iterable` and calls `callback(const ProgressInfo &)` at most every `interval`
+   * and once after the iteration. The total is taken from `std::size(iterable)` if available.
+   */
+  template <class T, class F> ProgressIterable<T, progress_detail::OwnedProgress> with_progress(
+    T && iterable, F && callback, Progress::Clock::duration interval = std::chrono::seconds(1)
+  ) {
+    auto total = progress_detail::sizeOf(iterable);
+    return ProgressIterable<T, progress_detail::OwnedProgress>(
+      std::forward<T>(iterable), Progress::Callback(std::forward<F>(callback)), interval, total
+    );
+  }
+
+  /**
+   * Iterates over `iterable` and adds its progress to the shared `progress`, e.g. for one chunk of a
+   * parallel loop. Call `progress.finish()` after all chunks are done for a final report.
+   */
+  template <class T> ProgressIterable<T, Progress &> with_progress(T && iterable, Progress &progress) {
+    return ProgressIterable<T, Progress &>(std::forward<T>(iterable), progress);
+  }
+
+}
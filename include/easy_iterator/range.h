@@ -0,0 +1,47 @@
+#pragma once
+
+#include "iterator.h"
+
+namespace easy_iterator {
+
+  /**
+   * Helper class for `range()`.
+   */
+  template <class T> struct RangeIterator final: public IteratorPrototype<T, dereference::ByValue> {
+    T increment;
+    
+    RangeIterator(const T &start, const T &_increment = 1):
+      IteratorPrototype<T, dereference::ByValue>(start),
+      increment(_increment) {
+    }
+    
+    RangeIterator &operator++(){ RangeIterator::value += increment; return *this; }
+  };
+  
+  template <class T> RangeIterator<T> rangeValue(T v, T i = 1){
+    return RangeIterator<T>(v, i);
+  }
+
+  /**
+   * Returns an iterator that increases it's value from `begin` to the first value <= `end` by `increment` for each step.
+   */
+  template <class T> auto range(T begin, T end, T increment) {
+    auto actualEnd = end - ((end - begin) % increment);
+    return wrap(rangeValue(begin, increment), rangeValue(actualEnd, increment));
+  }
+
+  /**
+   * Returns an iterator that increases it's value from `begin` to `end` by `1` for each step.
+   */
+  template <class T> auto range(T begin, T end) {
+    return range<T>(begin, end, 1);
+  }
+
+  /**
+   * Returns an iterator that increases it's value from `0` to `end` by `1` for each step.
+   */
+  template <class T> auto range(T end) {
+    return range<T>(0, end);
+  }
+
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+/**
+ * Run-length encoded columns. `rle_view(values, run_lengths)` iterates the expanded elements,
+ * while `sum`, `count_if`, `filter`, `copy`, `fill` and `zip_runs` work on whole runs and take
+ * time proportional to the number of runs instead of the number of elements.
+ * Usage:
+ *   auto status = rle_encode(statusColumn);
+ *   auto active = count_if(status, [](Status s){ return s == Status::active; });
+ *   for (auto [status, category, length]: zip_runs(status, categories)) { ... }
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "algorithm.h"
+#include "iterator.h"
+#include "zip.h"
+
+namespace easy_iterator {
+
+  namespace rle_detail {
+
+    /**
+     * Position in the runs of one column for `RunZipIterator`.
+     */
+    template <class VI, class LI, class LE> struct RunCursor {
+      VI value;
+      LI length;
+      LE lengthEnd;
+      size_t remaining = 0;
+
+      RunCursor(VI _value, LI _length, LE _lengthEnd):value(std::move(_value)),length(std::move(_length)),lengthEnd(std::move(_lengthEnd)){
+        enterRun();
+      }
+      void enterRun() {
+        while (length != lengthEnd && *length == 0) {
+          ++value;
+          ++length;
+        }
+        remaining = length != lengthEnd ? static_cast<size_t>(*length) : 0;
+      }
+      void advance(size_t step) {
+        if ((remaining -= step) == 0) {
+          ++value;
+          ++length;
+          enterRun();
+        }
+      }
+    };
+
+    /**
+     * Yields every value as often as its run length. Empty runs are skipped.
+     */
+    template <class Cursor> class ExpandingIterator {
+      Cursor cursor;
+    public:
+      explicit ExpandingIterator(Cursor _cursor):cursor(std::move(_cursor)){ }
+      decltype(auto) operator*() const { return *cursor.value; }
+      ExpandingIterator & operator++() {
+        cursor.advance(1);
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return cursor.remaining > 0; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+    /**
+     * Yields `(valueA, valueB, length)` for every stretch in which neither column changes its value.
+     */
+    template <class A, class B> class RunZipIterator {
+      A a;
+      B b;
+    public:
+      RunZipIterator(A _a, B _b):a(std::move(_a)),b(std::move(_b)){ }
+      auto operator*() const {
+        return std::tuple<decltype(*a.value), decltype(*b.value), size_t>(*a.value, *b.value, std::min(a.remaining, b.remaining));
+      }
+      RunZipIterator & operator++() {
+        auto step = std::min(a.remaining, b.remaining);
+        a.advance(step);
+        b.advance(step);
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return a.remaining > 0 && b.remaining > 0; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+    template <class V, class L> auto runCursor(const V &values, const L &lengths) {
+      using VI = std::decay_t<decltype(values.begin())>;
+      using LI = std::decay_t<decltype(lengths.begin())>;
+      using LE = std::decay_t<decltype(lengths.end())>;
+      return RunCursor<VI, LI, LE>(values.begin(), lengths.begin(), lengths.end());
+    }
+
+  }
+
+  /**
+   * A run-length encoded column: `values[i]` repeats `runLengths[i]` times. Both iterables are
+   * stored by reference for lvalues and by value otherwise.
+   * Behaviour is undefined if they do not have the same length.
+   */
+  template <class V, class L> class RleView {
+    V values;
+    L lengths;
+
+  public:
+    using value_type = std::decay_t<decltype(*std::declval<V &>().begin())>;
+    using length_type = std::decay_t<decltype(*std::declval<L &>().begin())>;
+
+    RleView(V && _values, L && _lengths):values(std::forward<V>(_values)),lengths(std::forward<L>(_lengths)){ }
+
+    auto begin() const {
+      auto cursor = rle_detail::runCursor(values, lengths);
+      return rle_detail::ExpandingIterator<decltype(cursor)>(std::move(cursor));
+    }
+    IterationEnd end() const { return IterationEnd(); }
+
+    /** Iterates the runs as `(value, length)`. */
+    auto runs() const { return zip(values, lengths); }
+
+    /** Iterates the runs as `(value, length)` with mutable values. */
+    auto runs() { return zip(values, lengths); }
+
+    const std::decay_t<V> & run_values() const { return values; }
+    const std::decay_t<L> & run_lengths() const { return lengths; }
+
+    /** The number of expanded elements. */
+    size_t size() const {
+      size_t total = 0;
+      for (auto &&length: lengths) { total += static_cast<size_t>(length); }
+      return total;
+    }
+  };
+
+  /**
+   * Returns a run-length encoded view where `values[i]` is repeated `run_lengths[i]` times.
+   */
+  template <class V, class L> RleView<V, L> rle_view(V && values, L && run_lengths) {
+    return RleView<V, L>(std::forward<V>(values), std::forward<L>(run_lengths));
+  }
+
+  /**
+   * Encodes the values of `iterable` into runs of equal values.
+   */
+  template <class T, class Length = size_t> auto rle_encode(T && iterable) {
+    using Value = std::decay_t<decltype(*iterable.begin())>;
+    std::vector<Value> values;
+    std::vector<Length> lengths;
+    for (auto &&v: iterable) {
+      if (!values.empty() && values.back() == v) {
+        ++lengths.back();
+      } else {
+        values.push_back(v);
+        lengths.push_back(1);
+      }
+    }
+    return rle_view(std::move(values), std::move(lengths));
+  }
+
+  /**
+   * Folds the runs of `rle` with `f(accumulator, value, length)`.
+   */
+  template <class V, class L, class T, class F> T reduce_runs(const RleView<V, L> &rle, T init, F && f) {
+    for (auto [value, length]: rle.runs()) { init = f(std::move(init), value, length); }
+    return init;
+  }
+
+  /**
+   * The sum of all expanded elements, computed as the sum of `value * length` over the runs.
+   * Accumulates in the promoted value type, so signed columns stay signed with unsigned lengths.
+   */
+  template <class V, class L> auto sum(const RleView<V, L> &rle) {
+    using Value = typename RleView<V, L>::value_type;
+    using R = decltype(std::declval<Value>() + std::declval<Value>());
+    return reduce_runs(rle, R(), [](R total, const auto &value, const auto &length){ return total + value * static_cast<R>(length); });
+  }
+
+  /**
+   * The number of expanded elements for which `predicate(value)` is true. Evaluated once per run.
+   */
+  template <class V, class L, class P> size_t count_if(const RleView<V, L> &rle, P && predicate) {
+    return reduce_runs(rle, size_t(0), [&](size_t count, const auto &value, const auto &length){
+      return predicate(value) ? count + static_cast<size_t>(length) : count;
+    });
+  }
+
+  /**
+   * Returns the runs for which `predicate(value)` is true as a new encoded column. Runs that become
+   * adjacent and have equal values are merged.
+   */
+  template <class V, class L, class P> auto filter(const RleView<V, L> &rle, P && predicate) {
+    std::vector<typename RleView<V, L>::value_type> values;
+    std::vector<typename RleView<V, L>::length_type> lengths;
+    for (auto [value, length]: rle.runs()) {
+      if (length == 0 || !predicate(value)) { continue; }
+      if (!values.empty() && values.back() == value) {
+        lengths.back() += length;
+      } else {
+        values.push_back(value);
+        lengths.push_back(length);
+      }
+    }
+    return rle_view(std::move(values), std::move(lengths));
+  }
+
+  /**
+   * Assigns `value` to every run.
+   */
+  template <class T, class V, class L> void fill(RleView<V, L> &rle, const T & value) {
+    for (auto [v, length]: rle.runs()) {
+      (void)length;
+      v = value;
+    }
+  }
+
+  /**
+   * Expands `a` into the random-access container `b`, filling one run at a time. The optional
+   * transformation `t` is applied once per run.
+   * Behaviour is undefined if `b` is shorter than `a`.
+   */
+  template <class V, class L, class B, class T = dereference::ByValueReference> void copy(const RleView<V, L> &a, B &b, T && t = T()) {
+    auto out = std::begin(b);
+    for (auto [value, length]: a.runs()) {
+      out = std::fill_n(out, length, t(value));
+    }
+  }
+
+  /**
+   * Iterates two encoded columns of the same length as `(valueA, valueB, length)` at run level.
+   * The result has at most as many runs as both columns together.
+   */
+  template <class VA, class LA, class VB, class LB> auto zip_runs(const RleView<VA, LA> &a, const RleView<VB, LB> &b) {
+    auto aCursor = rle_detail::runCursor(a.run_values(), a.run_lengths());
+    auto bCursor = rle_detail::runCursor(b.run_values(), b.run_lengths());
+    using Iterator = rle_detail::RunZipIterator<decltype(aCursor), decltype(bCursor)>;
+    return wrap(Iterator(std::move(aCursor), std::move(bCursor)), IterationEnd());
+  }
+
+}
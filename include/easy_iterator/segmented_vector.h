@@ -0,0 +1,198 @@
+#pragma once
+
+/**
+ * A vector made of geometrically growing segments that never moves its elements. One thread may
+ * append while any number of threads iterate the prefix that was published when they started.
+ * Usage:
+ *   SegmentedVector<Event> log;
+ *   log.push_back(event);                                  // writer thread
+ *   for_each(log, [](const Event &e){ ... });              // any reader thread
+ *   for (auto segment: log.segments()) { scan(segment.begin(), segment.end()); }
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "iterator.h"
+
+namespace easy_iterator {
+
+  namespace segmented_vector_detail {
+
+    constexpr unsigned log2(size_t value) { return value <= 1 ? 0 : 1 + log2(value / 2); }
+
+    /**
+     * A contiguous part of a segmented vector.
+     */
+    template <class T> struct Segment {
+      T * first;
+      T * last;
+      T * begin() const { return first; }
+      T * end() const { return last; }
+      size_t size() const { return static_cast<size_t>(last - first); }
+    };
+
+    /**
+     * Iterates the elements of a published prefix, one segment at a time.
+     */
+    template <class V> class ElementIterator {
+      using T = typename V::value_type;
+      const V * vector;
+      size_t segment = 0;
+      size_t remaining;
+      const T * current = nullptr;
+      const T * segmentEnd = nullptr;
+
+      void enterSegment() {
+        if (remaining == 0) { return; }
+        auto length = std::min(V::segment_capacity(segment), remaining);
+        current = vector->segment_data(segment);
+        segmentEnd = current + length;
+        remaining -= length;
+      }
+    public:
+      ElementIterator(const V &_vector, size_t count):vector(&_vector),remaining(count){ enterSegment(); }
+      const T & operator*() const { return *current; }
+      ElementIterator & operator++() {
+        if (++current == segmentEnd) {
+          ++segment;
+          enterSegment();
+        }
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return current != segmentEnd; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+    /**
+     * Iterates the segments of a published prefix as `Segment`s.
+     */
+    template <class V> class SegmentIterator {
+      using T = typename V::value_type;
+      const V * vector;
+      size_t segment = 0;
+      size_t remaining;
+    public:
+      SegmentIterator(const V &_vector, size_t count):vector(&_vector),remaining(count){ }
+      Segment<const T> operator*() const {
+        auto data = vector->segment_data(segment);
+        return Segment<const T>{data, data + std::min(V::segment_capacity(segment), remaining)};
+      }
+      SegmentIterator & operator++() {
+        remaining -= std::min(V::segment_capacity(segment), remaining);
+        ++segment;
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return remaining > 0; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+  }
+
+  /**
+   * A sequence of `T` stored in segments of `FirstSegment`, `2 * FirstSegment`, `4 * FirstSegment`,
+   * ... elements. Appending never moves existing elements, so references stay valid.
+   * Only one thread may call the modifying methods at a time. Other threads may concurrently read
+   * and iterate: `size()` publishes the number of fully constructed elements with release/acquire
+   * ordering and iteration covers the elements published when `begin()` or `segments()` was called.
+   */
+  template <class T, size_t FirstSegment = 16> class SegmentedVector {
+    static_assert(FirstSegment > 0 && (FirstSegment & (FirstSegment - 1)) == 0, "first segment size must be a power of two");
+    static constexpr unsigned firstBits = segmented_vector_detail::log2(FirstSegment);
+    static constexpr size_t maxSegments = 8 * sizeof(size_t) - firstBits;
+
+    std::array<std::atomic<T *>, maxSegments> segmentPointers{};
+    std::atomic<size_t> count{0};
+
+    template <class ... Args> T & append(Args && ... args) {
+      size_t index = count.load(std::memory_order_relaxed);
+      auto [segment, offset] = locate(index);
+      T * data = segmentPointers[segment].load(std::memory_order_relaxed);
+      if (data == nullptr) {
+        data = std::allocator<T>().allocate(segment_capacity(segment));
+        segmentPointers[segment].store(data, std::memory_order_release);
+      }
+      T * element = new (data + offset) T(std::forward<Args>(args)...);
+      count.store(index + 1, std::memory_order_release);
+      return *element;
+    }
+
+  public:
+    using value_type = T;
+
+    SegmentedVector() = default;
+    SegmentedVector(const SegmentedVector &) = delete;
+    SegmentedVector & operator=(const SegmentedVector &) = delete;
+
+    ~SegmentedVector() {
+      size_t remaining = count.load(std::memory_order_relaxed);
+      for (size_t segment = 0; segment < maxSegments; ++segment) {
+        T * data = segmentPointers[segment].load(std::memory_order_relaxed);
+        if (data == nullptr) { break; }
+        auto length = std::min(segment_capacity(segment), remaining);
+        for (size_t i = 0; i < length; ++i) { data[i].~T(); }
+        remaining -= length;
+        std::allocator<T>().deallocate(data, segment_capacity(segment));
+      }
+    }
+
+    /** The number of elements in `segment`. */
+    static constexpr size_t segment_capacity(size_t segment) { return FirstSegment << segment; }
+
+    /** The segment and offset within it of the element at `index`. */
+    static std::pair<size_t, size_t> locate(size_t index) {
+      size_t position = (index >> firstBits) + 1;
+      auto segment = static_cast<size_t>(8 * sizeof(unsigned long long) - 1 - __builtin_clzll(position));
+      return std::make_pair(segment, index - FirstSegment * ((size_t(1) << segment) - 1));
+    }
+
+    /** The storage of `segment`, which must hold a published element. */
+    const T * segment_data(size_t segment) const { return segmentPointers[segment].load(std::memory_order_acquire); }
+
+    void push_back(const T &value) { append(value); }
+    void push_back(T &&value) { append(std::move(value)); }
+    template <class ... Args> T & emplace_back(Args && ... args) { return append(std::forward<Args>(args)...); }
+
+    /** The number of published elements. */
+    size_t size() const { return count.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    /**
+     * The element at `index`, which must be smaller than a value previously returned by `size()`.
+     */
+    const T & operator[](size_t index) const {
+      auto [segment, offset] = locate(index);
+      return segment_data(segment)[offset];
+    }
+    T & operator[](size_t index) {
+      auto [segment, offset] = locate(index);
+      return segmentPointers[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    auto begin() const { return segmented_vector_detail::ElementIterator<SegmentedVector>(*this, size()); }
+    IterationEnd end() const { return IterationEnd(); }
+
+    /**
+     * Iterates the published elements as contiguous segments with `begin()`, `end()` and `size()`.
+     */
+    auto segments() const {
+      return wrap(segmented_vector_detail::SegmentIterator<SegmentedVector>(*this, size()), IterationEnd());
+    }
+  };
+
+  /**
+   * Calls `f` for every published element of `vector` with one tight loop per segment.
+   */
+  template <class T, size_t FirstSegment, class F> void for_each(const SegmentedVector<T, FirstSegment> &vector, F && f) {
+    for (auto segment: vector.segments()) {
+      for (auto it = segment.begin(), end = segment.end(); it != end; ++it) { f(*it); }
+    }
+  }
+
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+/**
+ * Deterministic partitioning of an iterable into disjoint shards, e.g. one per process.
+ * Every shard is computed independently from the shard id and the number of shards, so no
+ * coordination is needed. Shards are positioned with `skip()` (see `checkpoint.h`), which takes
+ * constant time for ranges, random-access containers, skippable generators and zips of those.
+ *
+ * - `shard(iterable, id, count)` assigns each shard one contiguous block. The length of the iterable
+ *   must be computable in constant time.
+ * - `shard(iterable, id, count, ShardBlocks{n})` assigns blocks of `n` elements round-robin and
+ *   also works for generators of unknown length.
+ * - `shard_by_key(iterable, id, count, key)` assigns elements by a stable hash of `key(element)`.
+ *   This visits every element, but keeps equal keys in the same shard. Keys other than integers
+ *   and strings need a hash that is stable across processes, passed as `shard_by_key(..., key, hash)`.
+ *
+ * All functions throw `std::invalid_argument` unless `id < count`.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "checkpoint.h"
+
+namespace easy_iterator {
+
+  /**
+   * Sharding mode with one contiguous block per shard.
+   */
+  struct ShardContiguous {
+  };
+
+  /**
+   * Round-robin sharding mode with blocks of `size` elements.
+   */
+  struct ShardBlocks {
+    size_t size;
+  };
+
+  /**
+   * A hash that is identical on every platform and process: the 64 bit finalizer of MurmurHash3
+   * for integers and FNV-1a for strings. There is no overload for other types since `std::hash`
+   * may differ between platforms and processes.
+   */
+  inline uint64_t stableHash(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+  }
+
+  inline uint64_t stableHash(std::string_view value) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (auto c: value) {
+      hash ^= static_cast<uint8_t>(c);
+      hash *= 0x100000001b3ULL;
+    }
+    return hash;
+  }
+
+  template <class T> uint64_t stableHash(const T &value) {
+    if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+      return stableHash(static_cast<uint64_t>(value));
+    } else {
+      static_assert(std::is_convertible<const T &, std::string_view>::value, "no stable hash for this type, pass a hash function to shard_by_key");
+      return stableHash(std::string_view(value));
+    }
+  }
+
+  /**
+   * Function object calling `stableHash`.
+   */
+  struct StableHash {
+    template <class T> uint64_t operator()(const T &value) const { return stableHash(value); }
+  };
+
+  namespace shard_detail {
+
+    template <class I, class E> struct HasLength: checkpoint_detail::IsRandomAccess<I, E> { };
+    template <class T> struct HasLength<RangeIterator<T>, RangeIterator<T>>: std::true_type { };
+    template <class ... Args, class ... EndArgs> struct HasLength<
+      checkpoint_detail::ZipIterator<FlatTuple<Args...>>, checkpoint_detail::ZipIterator<FlatTuple<EndArgs...>>
+    >: HasLength<
+      std::tuple_element_t<sizeof...(Args) - 1, std::tuple<Args...>>, std::tuple_element_t<sizeof...(EndArgs) - 1, std::tuple<EndArgs...>>
+    > { };
+
+    /**
+     * Returns the number of elements between `it` and `end` in constant time. The zip overload
+     * comes last so that it sees the overloads for its members.
+     */
+    template <class T> size_t length(const RangeIterator<T> &it, const RangeIterator<T> &end) {
+      return static_cast<size_t>((end.value - it.value) / it.increment);
+    }
+
+    template <class I> std::enable_if_t<checkpoint_detail::IsRandomAccess<I, I>::value, size_t> length(const I &it, const I &end) {
+      return static_cast<size_t>(end - it);
+    }
+
+    template <class ... Args, class ... EndArgs> size_t length(
+      const checkpoint_detail::ZipIterator<FlatTuple<Args...>> &it, const checkpoint_detail::ZipIterator<FlatTuple<EndArgs...>> &end
+    ) {
+      constexpr size_t last = sizeof...(Args) - 1;
+      return length(get<last>(it.value), get<last>(end.value));
+    }
+
+    /**
+     * Visits at most `remaining` elements of a contiguous shard.
+     */
+    template <class I, class E> class BlockIterator {
+      I iterator;
+      E end;
+      size_t remaining;
+    public:
+      BlockIterator(I _iterator, E _end, size_t _remaining):iterator(std::move(_iterator)),end(std::move(_end)),remaining(_remaining){ }
+      decltype(auto) operator*() { return *iterator; }
+      BlockIterator & operator++() {
+        ++iterator;
+        --remaining;
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return remaining > 0 && iterator != end; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+    /**
+     * Visits blocks of `blockSize` elements and skips the blocks of the other shards in between.
+     */
+    template <class I, class E> class RoundRobinIterator {
+      I iterator;
+      E end;
+      size_t blockSize;
+      size_t gap;
+      size_t remaining;
+    public:
+      RoundRobinIterator(I _iterator, E _end, size_t _blockSize, size_t _gap):
+        iterator(std::move(_iterator)),end(std::move(_end)),blockSize(_blockSize),gap(_gap),remaining(_blockSize){ }
+      decltype(auto) operator*() { return *iterator; }
+      RoundRobinIterator & operator++() {
+        ++iterator;
+        if (--remaining == 0) {
+          if (iterator != end) { checkpoint_detail::skip(iterator, end, gap); }
+          remaining = blockSize;
+        }
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return iterator != end; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+    /**
+     * Visits only the elements whose key hashes to the shard.
+     */
+    template <class I, class E, class K> class KeyIterator {
+      I iterator;
+      E end;
+      K * key;
+      size_t shardId;
+      size_t shardCount;
+
+      void findNext() {
+        while (iterator != end && (*key)(*iterator) % shardCount != shardId) { ++iterator; }
+      }
+    public:
+      KeyIterator(I _iterator, E _end, K &_key, size_t _shardId, size_t _shardCount):
+        iterator(std::move(_iterator)),end(std::move(_end)),key(&_key),shardId(_shardId),shardCount(_shardCount){
+        findNext();
+      }
+      decltype(auto) operator*() { return *iterator; }
+      KeyIterator & operator++() {
+        ++iterator;
+        findNext();
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return iterator != end; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+    /**
+     * Calls `key` and hashes the result with `hash`.
+     */
+    template <class F, class H> struct HashedKey {
+      F key;
+      H hash;
+      template <class V> uint64_t operator()(V && value) { return static_cast<uint64_t>(hash(key(std::forward<V>(value)))); }
+    };
+
+    inline void checkShard(size_t shardId, size_t shardCount) {
+      if (shardId >= shardCount) {
+        throw std::invalid_argument("shard id " + std::to_string(shardId) + " is not less than the shard count " + std::to_string(shardCount));
+      }
+    }
+
+  }
+
+  /**
+   * Iterable returned by `shard()` and `shard_by_key()`.
+   */
+  template <class T, class Mode> class ShardIterable {
+    T iterable;
+    Mode mode;
+    size_t shardId;
+    size_t shardCount;
+
+  public:
+    ShardIterable(T && _iterable, Mode _mode, size_t _shardId, size_t _shardCount):
+      iterable(std::forward<T>(_iterable)),mode(std::move(_mode)),shardId(_shardId),shardCount(_shardCount){
+      shard_detail::checkShard(shardId, shardCount);
+    }
+
+    auto begin() {
+      auto it = iterable.begin();
+      auto end = iterable.end();
+      using I = decltype(it);
+      using E = decltype(end);
+      if constexpr (std::is_same<Mode, ShardBlocks>::value) {
+        checkpoint_detail::skip(it, end, shardId * mode.size);
+        return shard_detail::RoundRobinIterator<I, E>(std::move(it), std::move(end), mode.size, (shardCount - 1) * mode.size);
+      } else if constexpr (std::is_same<Mode, ShardContiguous>::value) {
+        static_assert(shard_detail::HasLength<I, E>::value, "contiguous shards need a constant time length, use ShardBlocks instead");
+        auto total = shard_detail::length(it, end);
+        auto first = total * shardId / shardCount, last = total * (shardId + 1) / shardCount;
+        checkpoint_detail::skip(it, end, first);
+        return shard_detail::BlockIterator<I, E>(std::move(it), std::move(end), last - first);
+      } else {
+        return shard_detail::KeyIterator<I, E, Mode>(std::move(it), std::move(end), mode, shardId, shardCount);
+      }
+    }
+    IterationEnd end() const { return IterationEnd(); }
+  };
+
+  /**
+   * Returns the `shardId`-th of `shardCount` contiguous blocks of `iterable`. Block sizes differ by at most one.
+   */
+  template <class T> ShardIterable<T, ShardContiguous> shard(T && iterable, size_t shardId, size_t shardCount) {
+    return ShardIterable<T, ShardContiguous>(std::forward<T>(iterable), ShardContiguous(), shardId, shardCount);
+  }
+
+  /**
+   * Returns the blocks `shardId`, `shardId + shardCount`, `shardId + 2 * shardCount` ... of `iterable`.
+   */
+  template <class T> ShardIterable<T, ShardBlocks> shard(T && iterable, size_t shardId, size_t shardCount, ShardBlocks blocks) {
+    if (blocks.size == 0) { blocks.size = 1; }
+    return ShardIterable<T, ShardBlocks>(std::forward<T>(iterable), blocks, shardId, shardCount);
+  }
+
+  /**
+   * Returns the elements of `iterable` for which `hash(key(element)) % shardCount == shardId`.
+   * The hash must be identical in all processes that share the iterable.
+   */
+  template <class T, class K, class H = StableHash> ShardIterable<T, shard_detail::HashedKey<std::decay_t<K>, std::decay_t<H>>> shard_by_key(
+    T && iterable, size_t shardId, size_t shardCount, K && key, H && hash = H()
+  ) {
+    using Key = shard_detail::HashedKey<std::decay_t<K>, std::decay_t<H>>;
+    return ShardIterable<T, Key>(std::forward<T>(iterable), Key{std::forward<K>(key), std::forward<H>(hash)}, shardId, shardCount);
+  }
+
+}
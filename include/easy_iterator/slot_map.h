@@ -0,0 +1,175 @@
+#pragma once
+
+/**
+ * A slot map stores values contiguously and addresses them through generational handles that stay
+ * valid until the value is erased. Inserting and erasing take constant time, erasing moves the last
+ * value into the hole so iteration never skips dead slots.
+ * Usage:
+ *   SlotMap<Entity> entities;
+ *   auto handle = entities.insert(entity);
+ *   for (auto &entity: entities) { update(entity); }
+ *   for (auto [handle, entity]: zip(entities.handles(), entities.values())) { ... }
+ *   entities.erase(handle);
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "iterator.h"
+
+namespace easy_iterator {
+
+  /**
+   * Refers to a value in a `SlotMap`. Erasing the value invalidates all handles to it, even if its
+   * slot is reused later.
+   */
+  struct SlotHandle {
+    uint32_t index = std::numeric_limits<uint32_t>::max();
+    uint32_t generation = 0;
+
+    bool operator==(const SlotHandle &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SlotHandle &other) const { return !operator==(other); }
+  };
+
+  /**
+   * A container of `T` addressed by `SlotHandle`s with densely packed values.
+   * Inserting may reallocate the values, erasing changes their order. Handles are not affected.
+   */
+  template <class T> class SlotMap {
+    struct Slot {
+      // position in the dense arrays for live slots, next free slot otherwise; erasing bumps the generation
+      uint32_t target;
+      uint32_t generation;
+    };
+
+    static constexpr uint32_t noSlot = std::numeric_limits<uint32_t>::max();
+
+    std::vector<T> dense;
+    std::vector<SlotHandle> denseHandles;
+    std::vector<Slot> slots;
+    uint32_t freeSlot = noSlot;
+
+    const Slot * liveSlot(const SlotHandle &handle) const {
+      if (handle.index >= slots.size()) { return nullptr; }
+      auto &slot = slots[handle.index];
+      return slot.generation == handle.generation ? &slot : nullptr;
+    }
+
+  public:
+    using value_type = T;
+    using handle_type = SlotHandle;
+
+    /**
+     * Constructs a value from `args` and returns its handle.
+     */
+    template <class ... Args> SlotHandle emplace(Args && ... args) {
+      if (freeSlot == noSlot) {
+        if (slots.size() >= noSlot) { throw std::length_error("slot map is full"); }
+        slots.push_back(Slot{noSlot, 0});
+        freeSlot = static_cast<uint32_t>(slots.size() - 1);
+      }
+      auto &slot = slots[freeSlot];
+      SlotHandle handle{freeSlot, slot.generation};
+      denseHandles.push_back(handle);
+      try {
+        dense.emplace_back(std::forward<Args>(args)...);
+      } catch (...) {
+        denseHandles.pop_back();
+        throw;
+      }
+      freeSlot = slot.target;
+      slot.target = static_cast<uint32_t>(dense.size() - 1);
+      return handle;
+    }
+
+    SlotHandle insert(const T &value) { return emplace(value); }
+    SlotHandle insert(T &&value) { return emplace(std::move(value)); }
+
+    /**
+     * Erases the value of `handle` by moving the last value into its place.
+     * Returns false if the handle is no longer valid.
+     */
+    bool erase(const SlotHandle &handle) {
+      if (!liveSlot(handle)) { return false; }
+      auto &slot = slots[handle.index];
+      auto position = slot.target;
+      if (position + 1 != dense.size()) {
+        dense[position] = std::move(dense.back());
+        denseHandles[position] = denseHandles.back();
+        slots[denseHandles[position].index].target = position;
+      }
+      dense.pop_back();
+      denseHandles.pop_back();
+      ++slot.generation;
+      slot.target = freeSlot;
+      freeSlot = handle.index;
+      return true;
+    }
+
+    bool contains(const SlotHandle &handle) const { return liveSlot(handle) != nullptr; }
+
+    /** The value of `handle` or `nullptr` if the handle is no longer valid. */
+    const T * find(const SlotHandle &handle) const {
+      auto slot = liveSlot(handle);
+      return slot ? &dense[slot->target] : nullptr;
+    }
+    T * find(const SlotHandle &handle) {
+      auto slot = liveSlot(handle);
+      return slot ? &dense[slot->target] : nullptr;
+    }
+
+    /** The value of `handle`, which must be valid. */
+    const T & operator[](const SlotHandle &handle) const { return dense[slots[handle.index].target]; }
+    T & operator[](const SlotHandle &handle) { return dense[slots[handle.index].target]; }
+
+    /** The value of `handle`. Throws `std::out_of_range` if the handle is no longer valid. */
+    const T & at(const SlotHandle &handle) const {
+      if (auto value = find(handle)) { return *value; }
+      throw std::out_of_range("invalid slot map handle");
+    }
+    T & at(const SlotHandle &handle) {
+      if (auto value = find(handle)) { return *value; }
+      throw std::out_of_range("invalid slot map handle");
+    }
+
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+
+    void reserve(size_t capacity) {
+      dense.reserve(capacity);
+      denseHandles.reserve(capacity);
+      slots.reserve(capacity);
+    }
+
+    /**
+     * Erases all values and invalidates all handles.
+     */
+    void clear() {
+      for (auto &handle: denseHandles) {
+        auto &slot = slots[handle.index];
+        ++slot.generation;
+        slot.target = freeSlot;
+        freeSlot = handle.index;
+      }
+      dense.clear();
+      denseHandles.clear();
+    }
+
+    T * begin() { return dense.data(); }
+    T * end() { return dense.data() + dense.size(); }
+    const T * begin() const { return dense.data(); }
+    const T * end() const { return dense.data() + dense.size(); }
+
+    /** Iterates the values in storage order. */
+    auto values() { return valuesBetween(begin(), end()); }
+    auto values() const { return valuesBetween(begin(), end()); }
+
+    /** Iterates the handles in the same order as `values()`. */
+    auto handles() const { return valuesBetween(denseHandles.data(), denseHandles.data() + denseHandles.size()); }
+  };
+
+}
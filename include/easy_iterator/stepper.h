@@ -0,0 +1,163 @@
+#pragma once
+
+/**
+ * Resumable iteration for cooperative scheduling. A stepper keeps its position in an iterable and
+ * processes at most a budget of elements or time per call, so that a long scan can be interleaved
+ * with other work on an event loop thread.
+ * Usage:
+ *   auto scan = stepper(rows, [&](auto &row){ process(row); });
+ *   while (!scan.done()) { scan.run_for(std::chrono::microseconds(500)); pollNetwork(); }
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "checkpoint.h"
+#include "stop.h"
+
+namespace easy_iterator {
+
+  /**
+   * The state returned by `Stepper::checkpoint()`: the number of elements visited or skipped and
+   * the checkpoint of the iterator.
+   */
+  template <class S> struct StepperState {
+    size_t position;
+    S iterator;
+  };
+
+  /**
+   * Keeps an iteration over `T` and advances it on demand. The iterable is stored by reference for
+   * lvalues and by value otherwise. Since the position refers to the stored iterable, steppers can
+   * neither be copied nor moved.
+   */
+  template <class T> class Stepper {
+    using I = std::decay_t<decltype(std::declval<T &>().begin())>;
+    using E = std::decay_t<decltype(std::declval<T &>().end())>;
+
+    T iterable;
+    std::optional<I> first;
+    std::optional<I> current;
+    std::optional<E> last;
+    size_t visited = 0;
+    stop_detail::AdaptiveInterval interval;
+
+    bool hasNext() {
+      if (!current) {
+        current.emplace(iterable.begin());
+        last.emplace(iterable.end());
+        first.emplace(static_cast<const I &>(*current));
+      }
+      return *current != *last;
+    }
+
+    template <class F> void visit(F &f) {
+      f(**current);
+      ++*current;
+      ++visited;
+    }
+
+  public:
+    explicit Stepper(T && _iterable):iterable(std::forward<T>(_iterable)){ }
+    Stepper(const Stepper &) = delete;
+    Stepper & operator=(const Stepper &) = delete;
+
+    /**
+     * Calls `f` for at most `n` of the remaining elements. Returns the number of elements visited.
+     */
+    template <class F> size_t run_for(size_t n, F && f) {
+      size_t count = 0;
+      for (; count < n && hasNext(); ++count) { visit(f); }
+      return count;
+    }
+
+    /**
+     * Calls `f` for the remaining elements until `budget` has elapsed. The clock is read every K
+     * elements as in `until()`, so the budget may be exceeded by about a microsecond.
+     * Returns the number of elements visited.
+     */
+    template <class Rep, class Period, class F> size_t run_for(std::chrono::duration<Rep, Period> budget, F && f) {
+      auto now = stop_detail::Clock::now();
+      auto deadline = now + budget;
+      interval.restart(now);
+      size_t count = 0;
+      while (hasNext()) {
+        visit(f);
+        ++count;
+        if (interval.step(now) && now >= deadline) { break; }
+      }
+      return count;
+    }
+
+    /**
+     * True if all elements have been visited.
+     */
+    bool done() { return !hasNext(); }
+
+    /**
+     * The number of elements visited or skipped so far.
+     */
+    size_t position() const { return visited; }
+
+    /**
+     * Returns the state of the current position for iterables supported by `checkpoint()`.
+     */
+    StepperState<CheckpointState<I>> checkpoint() {
+      hasNext();
+      return StepperState<CheckpointState<I>>{visited, easy_iterator::checkpoint(*current, *first)};
+    }
+
+    /**
+     * Continues from a state returned by `checkpoint()` of a stepper over an equivalent iterable.
+     * Must be called before any element is visited.
+     */
+    template <class S> void resume(const StepperState<S> &state) {
+      hasNext();
+      restore(*current, state.iterator);
+      visited = state.position;
+    }
+
+    /**
+     * Skips at most `n` elements without visiting them. Returns the number of skipped elements.
+     */
+    size_t skip(size_t n) {
+      hasNext();
+      auto count = checkpoint_detail::skip(*current, *last, n);
+      visited += count;
+      return count;
+    }
+  };
+
+  /**
+   * A `Stepper` that calls a fixed function for every element.
+   */
+  template <class T, class F> class BoundStepper: public Stepper<T> {
+    F function;
+  public:
+    BoundStepper(T && iterable, F _function):Stepper<T>(std::forward<T>(iterable)),function(std::move(_function)){ }
+
+    using Stepper<T>::run_for;
+    size_t run_for(size_t n) { return Stepper<T>::run_for(n, function); }
+    template <class Rep, class Period> size_t run_for(std::chrono::duration<Rep, Period> budget) {
+      return Stepper<T>::run_for(budget, function);
+    }
+  };
+
+  /**
+   * Returns a stepper over `iterable`. Elements are passed to the function given to `run_for()`.
+   */
+  template <class T> Stepper<T> stepper(T && iterable) {
+    return Stepper<T>(std::forward<T>(iterable));
+  }
+
+  /**
+   * Returns a stepper that calls `f` for every element of `iterable`.
+   */
+  template <class T, class F> BoundStepper<T, std::decay_t<F>> stepper(T && iterable, F && f) {
+    return BoundStepper<T, std::decay_t<F>>(std::forward<T>(iterable), std::forward<F>(f));
+  }
+
+}
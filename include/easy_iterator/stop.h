@@ -0,0 +1,183 @@
+#pragma once
+
+/**
+ * Iteration that ends early at a deadline or on cancellation. The condition is checked every K
+ * elements, where K adapts so that the checks take about 1% of the loop time. A stopped
+ * iteration ends cleanly at `IterationEnd`, so partial results computed so far stay valid.
+ * Usage:
+ *   auto loop = until(values, Clock::now() + std::chrono::milliseconds(5));
+ *   for (auto &v: loop) { ... }
+ *   if (loop.stopped()) { ... }
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "iterator.h"
+
+namespace easy_iterator {
+
+  /**
+   * Observes the stop state of a `StopSource`. Copies share the same state, so one token can be
+   * handed to every worker of a parallel loop. Any type with `bool stop_requested() const`, such
+   * as `std::stop_token`, can be used in place of `StopToken`.
+   */
+  class StopToken {
+    std::shared_ptr<const std::atomic<bool>> state;
+  public:
+    StopToken() = default;
+    explicit StopToken(std::shared_ptr<const std::atomic<bool>> _state):state(std::move(_state)){ }
+    bool stop_possible() const { return bool(state); }
+    bool stop_requested() const { return state && state->load(std::memory_order_relaxed); }
+  };
+
+  /**
+   * Requests cancellation of all iterations observing one of its tokens.
+   */
+  class StopSource {
+    std::shared_ptr<std::atomic<bool>> state = std::make_shared<std::atomic<bool>>(false);
+  public:
+    StopToken get_token() const { return StopToken(state); }
+    bool stop_requested() const { return state->load(std::memory_order_relaxed); }
+    /** Returns true if this call requested the stop. */
+    bool request_stop() { return !state->exchange(true, std::memory_order_relaxed); }
+  };
+
+  namespace stop_detail {
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * The cost of reading the clock, measured once.
+     */
+    inline Clock::duration clockCost() {
+      static const Clock::duration cost = [](){
+        constexpr int reads = 1000;
+        auto start = Clock::now();
+        auto last = start;
+        for (int i = 0; i < reads; ++i) { last = Clock::now(); }
+        return std::max(Clock::duration(1), (last - start) / reads);
+      }();
+      return cost;
+    }
+
+    /**
+     * Decides when to check. Doubles K while the time between checks is below 100 times the check
+     * cost and halves it when the time is above 400 times the check cost.
+     */
+    class AdaptiveInterval {
+      uint64_t interval = 1;
+      uint64_t countdown = 1;
+      Clock::duration target = 100 * clockCost();
+      Clock::time_point last = Clock::now();
+    public:
+      static constexpr uint64_t maxInterval = uint64_t(1) << 20;
+
+      /** Returns true and the current time every K calls. */
+      bool step(Clock::time_point &now) {
+        if (--countdown != 0) { return false; }
+        now = Clock::now();
+        auto elapsed = now - last;
+        last = now;
+        if (elapsed < target && interval < maxInterval) { interval *= 2; }
+        else if (elapsed > 4 * target && interval > 1) { interval /= 2; }
+        countdown = interval;
+        return true;
+      }
+
+      /** Starts a new measurement period at `now` and keeps the current K, e.g. after a pause. */
+      void restart(Clock::time_point now) {
+        last = now;
+        countdown = interval;
+      }
+
+      uint64_t current() const { return interval; }
+    };
+
+    template <class I, class E, class S> class StoppingIterator {
+      I iterator;
+      E end;
+      S * state;
+    public:
+      StoppingIterator(I _iterator, E _end, S &_state):iterator(std::move(_iterator)),end(std::move(_end)),state(&_state){ }
+      decltype(auto) operator*() { return *iterator; }
+      StoppingIterator & operator++() {
+        ++iterator;
+        Clock::time_point now;
+        // once the last element was visited the iteration is complete, whatever the condition says
+        if (iterator != end && state->interval.step(now)) { state->check(now); }
+        return *this;
+      }
+      bool operator!=(const IterationEnd &) const { return !state->stoppedEarly && iterator != end; }
+      bool operator==(const IterationEnd &other) const { return !operator!=(other); }
+    };
+
+    struct Deadline {
+      Clock::time_point deadline;
+      bool operator()(Clock::time_point now) const { return now >= deadline; }
+    };
+
+    template <class Token> struct Cancellation {
+      Token token;
+      bool operator()(Clock::time_point) const { return token.stop_requested(); }
+    };
+
+  }
+
+  /**
+   * Iterable returned by `until()` and `cancellable()`. The condition `C` is called with the current
+   * time and returns true to stop.
+   */
+  template <class T, class C> class StoppingIterable {
+    template <class, class, class> friend class stop_detail::StoppingIterator;
+
+    T iterable;
+    C condition;
+    stop_detail::AdaptiveInterval interval;
+    bool stoppedEarly = false;
+
+    void check(stop_detail::Clock::time_point now) { stoppedEarly = condition(now); }
+
+  public:
+    StoppingIterable(T && _iterable, C _condition):iterable(std::forward<T>(_iterable)),condition(std::move(_condition)){ }
+    StoppingIterable(const StoppingIterable &) = delete;
+    StoppingIterable & operator=(const StoppingIterable &) = delete;
+
+    auto begin() {
+      using I = std::decay_t<decltype(iterable.begin())>;
+      using E = std::decay_t<decltype(iterable.end())>;
+      auto first = iterable.begin();
+      auto last = iterable.end();
+      if (first != last) { check(stop_detail::Clock::now()); }
+      return stop_detail::StoppingIterator<I, E, StoppingIterable>(std::move(first), std::move(last), *this);
+    }
+    IterationEnd end() const { return IterationEnd(); }
+
+    /**
+     * True if the iteration ended because the condition was met rather than at the end of the iterable.
+     */
+    bool stopped() const { return stoppedEarly; }
+  };
+
+  /**
+   * Iterates over `iterable` until `deadline` has passed.
+   */
+  template <class T, class Duration> StoppingIterable<T, stop_detail::Deadline> until(
+    T && iterable, std::chrono::time_point<stop_detail::Clock, Duration> deadline
+  ) {
+    return StoppingIterable<T, stop_detail::Deadline>(std::forward<T>(iterable), stop_detail::Deadline{deadline});
+  }
+
+  /**
+   * Iterates over `iterable` until a stop is requested on `token`.
+   */
+  template <class T, class Token> StoppingIterable<T, stop_detail::Cancellation<Token>> cancellable(T && iterable, Token token) {
+    return StoppingIterable<T, stop_detail::Cancellation<Token>>(std::forward<T>(iterable), stop_detail::Cancellation<Token>{std::move(token)});
+  }
+
+}
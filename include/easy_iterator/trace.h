@@ -0,0 +1,254 @@
+#pragma once
+
+/**
+ * Begin/end trace events in the Chrome trace event format (viewable in `chrome://tracing` or Perfetto).
+ * Every thread records into its own lock-free ring buffer and a background thread flushes all
+ * buffers to the output periodically, so recording an event only reads the clock and writes a
+ * few words. If a buffer is full, events are dropped and counted instead of blocking the thread.
+ * While no trace is running, recording is a single atomic load.
+ * Usage:
+ *   trace::Tracer::global().start("trace.json");
+ *   { trace::Span span("chunk"); ... }
+ *   trace::Tracer::global().stop();
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace easy_iterator {
+
+  namespace trace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+      /** Must outlive the trace, e.g. a string literal. */
+      const char * name;
+      uint64_t ns;
+      char phase;
+    };
+
+    /**
+     * Single-producer single-consumer ring buffer owned by one thread and drained by the flusher.
+     */
+    class ThreadBuffer {
+    public:
+      static constexpr size_t capacity = size_t(1) << 14;
+
+      explicit ThreadBuffer(uint32_t _threadId):threadId(_threadId){ }
+
+      bool push(const Event &event) {
+        auto h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == capacity) { return false; }
+        events[h % capacity] = event;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+      }
+
+      /**
+       * Calls `f(const Event &)` for every available event and removes them. Only called by the consumer.
+       */
+      template <class F> void drain(F && f) {
+        auto t = tail.load(std::memory_order_relaxed);
+        auto h = head.load(std::memory_order_acquire);
+        for (; t != h; ++t) { f(events[t % capacity]); }
+        tail.store(t, std::memory_order_release);
+      }
+
+      void clear() { tail.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+
+      /** Trace thread id. Buffers are reused by later threads, so this identifies a slot rather than an OS thread. */
+      const uint32_t threadId;
+      std::atomic<bool> owned{true};
+
+    private:
+      alignas(64) std::atomic<uint64_t> head{0};
+      alignas(64) std::atomic<uint64_t> tail{0};
+      std::array<Event, capacity> events;
+    };
+
+    class Tracer {
+    public:
+      static Tracer & global() {
+        static Tracer tracer;
+        return tracer;
+      }
+
+      ~Tracer() { stop(); }
+
+      /**
+       * Starts writing a trace to the file at `path`. Returns false if the file cannot be opened.
+       */
+      bool start(const std::string &path, std::chrono::milliseconds flushInterval = std::chrono::milliseconds(100)) {
+        auto file = std::make_unique<std::ofstream>(path);
+        if (!*file) { return false; }
+        start(*file, flushInterval);
+        ownedStream = std::move(file);
+        return true;
+      }
+
+      /**
+       * Starts writing a trace to `stream`, which must stay valid until `stop()` returns.
+       */
+      void start(std::ostream &stream, std::chrono::milliseconds flushInterval = std::chrono::milliseconds(100)) {
+        stop();
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          for (auto &buffer: buffers) { buffer->clear(); }
+        }
+        output = &stream;
+        firstEvent = true;
+        droppedEvents.store(0, std::memory_order_relaxed);
+        origin.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        *output << "{\"traceEvents\":[";
+        running = true;
+        active.store(true, std::memory_order_release);
+        flusher = std::thread([this, flushInterval](){
+          std::unique_lock<std::mutex> lock(flusherMutex);
+          while (running) {
+            flusherCondition.wait_for(lock, flushInterval);
+            flush();
+          }
+        });
+      }
+
+      /**
+       * Stops the trace, flushes all remaining events and finishes the output.
+       */
+      void stop() {
+        if (!flusher.joinable()) { return; }
+        active.store(false, std::memory_order_release);
+        {
+          std::lock_guard<std::mutex> lock(flusherMutex);
+          running = false;
+        }
+        flusherCondition.notify_one();
+        flusher.join();
+        flush();
+        *output << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << dropped() << "}}" << std::endl;
+        output = nullptr;
+        ownedStream.reset();
+      }
+
+      bool enabled() const { return active.load(std::memory_order_acquire); }
+
+      /**
+       * Number of events dropped because a thread buffer was full.
+       */
+      uint64_t dropped() const { return droppedEvents.load(std::memory_order_relaxed); }
+
+      void record(const char * name, char phase) {
+        if (!enabled()) { return; }
+        auto start = Clock::time_point(Clock::duration(origin.load(std::memory_order_relaxed)));
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        if (!threadBuffer().push(Event{name, static_cast<uint64_t>(ns), phase})) {
+          droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+
+    private:
+      Tracer() = default;
+
+      /**
+       * Releases the buffer for reuse by another thread when the owning thread exits.
+       */
+      struct BufferOwner {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~BufferOwner() { if (buffer) { buffer->owned.store(false, std::memory_order_release); } }
+      };
+
+      ThreadBuffer & threadBuffer() {
+        thread_local BufferOwner owner;
+        if (!owner.buffer) {
+          std::lock_guard<std::mutex> lock(mutex);
+          // buffers of exited threads are reused, so short-lived threads do not grow the registry
+          for (auto &buffer: buffers) {
+            bool owned = false;
+            if (buffer->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+              owner.buffer = buffer;
+              return *buffer;
+            }
+          }
+          owner.buffer = std::make_shared<ThreadBuffer>(static_cast<uint32_t>(buffers.size() + 1));
+          buffers.push_back(owner.buffer);
+        }
+        return *owner.buffer;
+      }
+
+      static void writeEscaped(std::ostream &stream, const char * str) {
+        for (; *str; ++str) {
+          if (*str == '"' || *str == '\\') { stream << '\\'; }
+          stream << *str;
+        }
+      }
+
+      void flush() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &buffer: buffers) {
+          buffer->drain([&](const Event &event){
+            *output << (firstEvent ? "\n" : ",\n") << "{\"name\":\"";
+            writeEscaped(*output, event.name);
+            *output << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.ns / 1000 << '.';
+            auto fraction = event.ns % 1000;
+            *output << char('0' + fraction / 100) << char('0' + fraction / 10 % 10) << char('0' + fraction % 10);
+            *output << ",\"pid\":1,\"tid\":" << buffer->threadId << "}";
+            firstEvent = false;
+          });
+        }
+        output->flush();
+      }
+
+      std::atomic<bool> active{false};
+      std::atomic<uint64_t> droppedEvents{0};
+      // published by the release store of `active`, atomic since a thread may still record while
+      // the next trace is started
+      std::atomic<Clock::rep> origin{0};
+
+      std::mutex mutex;
+      std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+      std::ostream * output = nullptr;
+      std::unique_ptr<std::ostream> ownedStream;
+      bool firstEvent = true;
+
+      std::thread flusher;
+      std::mutex flusherMutex;
+      std::condition_variable flusherCondition;
+      bool running = false;
+    };
+
+    /**
+     * Records a begin event for `name` on the current thread.
+     */
+    inline void begin(const char * name) { Tracer::global().record(name, 'B'); }
+
+    /**
+     * Records an end event for `name` on the current thread.
+     */
+    inline void end(const char * name) { Tracer::global().record(name, 'E'); }
+
+    /**
+     * Records a begin event on construction and the matching end event on destruction.
+     */
+    class Span {
+      const char * name;
+    public:
+      explicit Span(const char * _name):name(_name){ begin(name); }
+      Span(const Span &) = delete;
+      Span & operator=(const Span &) = delete;
+      ~Span() { end(name); }
+    };
+
+  }
+
+}
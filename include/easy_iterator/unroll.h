@@ -0,0 +1,110 @@
+#pragma once
+
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include "range.h"
+#include "zip.h"
+
+namespace easy_iterator {
+
+  namespace unroll_detail {
+    template <class I, class E, class = void> struct IsRandomAccess: std::false_type { };
+    template <class I> struct IsRandomAccess<I, I, std::void_t<typename std::iterator_traits<I>::iterator_category>>: std::is_base_of<
+      std::random_access_iterator_tag,
+      typename std::iterator_traits<I>::iterator_category
+    > { };
+
+    template <class I> struct IsRange: std::false_type { };
+    template <class T> struct IsRange<RangeIterator<T>>: std::true_type { };
+
+    template <class I, class F, size_t ... Idx> void callAtOffsets(const I &it, F &f, std::index_sequence<Idx...>) {
+      using Difference = typename std::iterator_traits<I>::difference_type;
+      (f(*(it + static_cast<Difference>(Idx))), ...);
+    }
+
+    template <class T, class F, size_t ... Idx> void callAtRangeOffsets(const RangeIterator<T> &it, F &f, std::index_sequence<Idx...>) {
+      (f(static_cast<T>(it.value + static_cast<T>(Idx) * it.increment)), ...);
+    }
+
+    template <class I> struct IsOffsettable: std::integral_constant<bool, IsRandomAccess<I, I>::value || IsRange<I>::value> { };
+
+    /**
+     * The value `k` elements after `it` and moving `it` by `n` elements for offsettable iterators.
+     */
+    template <class I> decltype(auto) valueAt(const I &it, size_t k) {
+      if constexpr (IsRange<I>::value) { return static_cast<decltype(it.value)>(it.value + static_cast<decltype(it.value)>(k) * it.increment); }
+      else { return *(it + static_cast<typename std::iterator_traits<I>::difference_type>(k)); }
+    }
+
+    template <class I> void advanceBy(I &it, size_t n) {
+      if constexpr (IsRange<I>::value) { it.value += static_cast<decltype(it.value)>(n) * it.increment; }
+      else { it += static_cast<typename std::iterator_traits<I>::difference_type>(n); }
+    }
+
+    template <class I> size_t distance(const I &it, const I &end) {
+      if constexpr (IsRange<I>::value) { return static_cast<size_t>((end.value - it.value) / it.increment); }
+      else { return static_cast<size_t>(end - it); }
+    }
+
+    template <class Z> using ZipIterator = Iterator<Z, increment::ByTupleIncrement, dereference::ByTupleDereference, compare::ByLastTupleElementMatch>;
+
+    /**
+     * True for zips whose members are all random-access iterators or ranges. As in `zip`, the last
+     * member determines the length, so only its end needs to be of the same type.
+     */
+    template <class I, class E> struct IsOffsetZip: std::false_type { };
+    template <class ... Args, class ... EndArgs> struct IsOffsetZip<ZipIterator<FlatTuple<Args...>>, ZipIterator<FlatTuple<EndArgs...>>>: std::integral_constant<bool,
+      (IsOffsettable<Args>::value && ...) &&
+      std::is_same<std::tuple_element_t<sizeof...(Args) - 1, std::tuple<Args...>>, std::tuple_element_t<sizeof...(EndArgs) - 1, std::tuple<EndArgs...>>>::value
+    > { };
+
+    template <class ... Args, size_t ... J> auto zipValueAt(const FlatTuple<Args...> &members, size_t k, std::index_sequence<J...>) {
+      return std::tuple<decltype(*std::declval<Args &>())...>(valueAt(get<J>(members), k)...);
+    }
+
+    template <class ... Args, class F, size_t ... Idx> void callAtZipOffsets(const FlatTuple<Args...> &members, F &f, std::index_sequence<Idx...>) {
+      (f(zipValueAt(members, Idx, std::index_sequence_for<Args...>())), ...);
+    }
+
+    template <class ... Args, size_t ... J> void advanceZip(FlatTuple<Args...> &members, size_t n, std::index_sequence<J...>) {
+      (advanceBy(get<J>(members), n), ...);
+    }
+  }
+
+  /**
+   * Calls `f` for every value of `iterable`, manually unrolled by a factor of `N`.
+   * For random-access iterators, ranges and zips (including `enumerate`) of those, `f` is invoked `N`
+   * times per step with offsets known at compile time, followed by a loop over the remaining elements.
+   * Other iterables fall back to regular iteration.
+   */
+  template <size_t N, class T, class F> void unroll(T && iterable, F && f) {
+    static_assert(N > 0, "unroll factor must be positive");
+    auto it = iterable.begin();
+    auto end = iterable.end();
+    using I = decltype(it);
+    using E = decltype(end);
+    if constexpr (unroll_detail::IsRandomAccess<I, E>::value) {
+      for (auto remaining = end - it; remaining >= static_cast<decltype(remaining)>(N); remaining -= N) {
+        unroll_detail::callAtOffsets(it, f, std::make_index_sequence<N>());
+        it += N;
+      }
+    } else if constexpr (unroll_detail::IsRange<I>::value && std::is_same<I, E>::value) {
+      for (auto remaining = (end.value - it.value) / it.increment; remaining >= static_cast<decltype(remaining)>(N); remaining -= N) {
+        unroll_detail::callAtRangeOffsets(it, f, std::make_index_sequence<N>());
+        it.value += static_cast<decltype(it.value)>(N) * it.increment;
+      }
+    } else if constexpr (unroll_detail::IsOffsetZip<I, E>::value) {
+      constexpr size_t last = std::tuple_size<decltype(it.value)>::value - 1;
+      for (auto remaining = unroll_detail::distance(get<last>(it.value), get<last>(end.value)); remaining >= N; remaining -= N) {
+        unroll_detail::callAtZipOffsets(it.value, f, std::make_index_sequence<N>());
+        unroll_detail::advanceZip(it.value, N, std::make_index_sequence<last + 1>());
+      }
+    }
+    for (; it != end; ++it) {
+      f(*it);
+    }
+  }
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include "iterator.h"
+#include "range.h"
+
+namespace easy_iterator {
+
+  namespace zip_detail {
+    template <size_t Idx, class T> struct Leaf {
+      T value;
+    };
+
+    template <class Seq, class ... T> struct FlatStorage;
+    template <size_t ... Idx, class ... T> struct FlatStorage<std::index_sequence<Idx...>, T...>: Leaf<Idx, T>... {
+    };
+
+    template <size_t Idx, class T> T & getLeaf(Leaf<Idx, T> &leaf){ return leaf.value; }
+    template <size_t Idx, class T> const T & getLeaf(const Leaf<Idx, T> &leaf){ return leaf.value; }
+    template <size_t Idx, class T> T leafType(const Leaf<Idx, T> &);
+  }
+
+  /**
+   * A flat, index-based alternative to `std::tuple` used to store the iterators of `zip`.
+   * All elements are direct base classes, so accessing an element does not recursively instantiate
+   * `std::tuple` helpers.
+   */
+  template <class ... T> struct FlatTuple: zip_detail::FlatStorage<std::index_sequence_for<T...>, T...> {
+  };
+
+  template <size_t Idx, class ... T> auto & get(FlatTuple<T...> &v){ return zip_detail::getLeaf<Idx>(v); }
+  template <size_t Idx, class ... T> auto & get(const FlatTuple<T...> &v){ return zip_detail::getLeaf<Idx>(v); }
+
+  template <class ... T> FlatTuple<typename std::decay<T>::type...> makeFlatTuple(T && ... values){
+    return FlatTuple<typename std::decay<T>::type...>{{{std::forward<T>(values)}...}};
+  }
+
+}
+
+namespace std {
+  template <class ... T> struct tuple_size<easy_iterator::FlatTuple<T...>>: std::integral_constant<size_t, sizeof...(T)> { };
+  template <size_t Idx, class ... T> struct tuple_element<Idx, easy_iterator::FlatTuple<T...>> {
+    using type = decltype(easy_iterator::zip_detail::leafType<Idx>(std::declval<const easy_iterator::FlatTuple<T...> &>()));
+  };
+}
+
+namespace easy_iterator {
+
+  namespace compare {
+    struct ByLastTupleElementMatch {
+      template <class A, class B> bool operator()(const A & a, const B &b) const {
+        constexpr size_t N = std::tuple_size<A>::value;
+        static_assert(N == std::tuple_size<B>::value, "comparing invalid tuples");
+        using std::get;
+        return get<N-1>(a) == get<N-1>(b);
+      }
+    };
+  }
+
+  namespace increment {
+    struct ByTupleIncrement {
+      template <typename ... Args> void dummy(Args &&...) { }
+      template <class T, size_t ... Idx> void updateValues(T & v, std::index_sequence<Idx...>) {
+        using std::get;
+        dummy(++get<Idx>(v)...);
+      }
+      template <class T> void operator()(T & v) {
+        updateValues(v, std::make_index_sequence<std::tuple_size<T>::value>());
+      }
+    };
+  }
+
+  namespace dereference {
+    struct ByTupleDereference {
+      template <size_t ... Idx, class T> auto getReferenceTuple(T & v, std::index_sequence<Idx...>) const {
+        using std::get;
+        return std::tuple<decltype(*get<Idx>(v))...>(*get<Idx>(v)...);
+      }
+      template <class T> auto operator()(T & v) const {
+        return getReferenceTuple(v, std::make_index_sequence<std::tuple_size<T>::value>());
+      }
+    };
+  }
+
+  /**
+   * Returns an iterable object where all argument iterators are traversed simultaneously.
+   * Behaviour is undefined if the iterators do not have the same length.
+   */
+  template <typename ... Args> auto zip(Args && ... args){
+    auto begin = Iterator(makeFlatTuple(args.begin()...), increment::ByTupleIncrement(), dereference::ByTupleDereference(), compare::ByLastTupleElementMatch());
+    auto end = Iterator(makeFlatTuple(args.end()...), increment::ByTupleIncrement(), dereference::ByTupleDereference(), compare::ByLastTupleElementMatch());
+    return wrap(std::move(begin), std::move(end));
+  }
+
+  /**
+   * Returns an object that is iterated as `[index, value]`.
+   */
+  template <class T> auto enumerate(T && t){
+    return zip(wrap(RangeIterator(0), IterationEnd()), t);
+  }
+
+}
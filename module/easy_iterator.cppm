@@ -0,0 +1,20 @@
+/**
+ * C++20 module interface for EasyIterator. Standard library headers are included in the global
+ * module fragment, so only the EasyIterator declarations are attached to and exported by the module.
+ * Usage: `import easy_iterator;`
+ */
+
+module;
+
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+export module easy_iterator;
+
+export {
+#include <easy_iterator.h>
+}
@@ -0,0 +1,72 @@
+#include "allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+  thread_local easy_iterator::AllocationCounts counts;
+
+  void * allocate(std::size_t size){
+    ++counts.allocations;
+    counts.bytes += size;
+    return std::malloc(size ? size : 1);
+  }
+
+  void * allocateAligned(std::size_t size, std::align_val_t alignment){
+    ++counts.allocations;
+    counts.bytes += size;
+    auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc requires the size to be a multiple of the alignment
+    return std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align);
+  }
+
+  void deallocate(void * pointer){
+    if (pointer) {
+      ++counts.deallocations;
+      std::free(pointer);
+    }
+  }
+}
+
+namespace easy_iterator {
+  AllocationCounts currentAllocationCounts(){ return counts; }
+}
+
+void * operator new(std::size_t size){
+  if (auto p = allocate(size)) { return p; }
+  throw std::bad_alloc();
+}
+
+void * operator new[](std::size_t size){
+  if (auto p = allocate(size)) { return p; }
+  throw std::bad_alloc();
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+
+void * operator new(std::size_t size, std::align_val_t alignment){
+  if (auto p = allocateAligned(size, alignment)) { return p; }
+  throw std::bad_alloc();
+}
+
+void * operator new[](std::size_t size, std::align_val_t alignment){
+  if (auto p = allocateAligned(size, alignment)) { return p; }
+  throw std::bad_alloc();
+}
+
+void * operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return allocateAligned(size, alignment); }
+void * operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return allocateAligned(size, alignment); }
+
+void operator delete(void * pointer) noexcept { deallocate(pointer); }
+void operator delete[](void * pointer) noexcept { deallocate(pointer); }
+void operator delete(void * pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete[](void * pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete(void * pointer, const std::nothrow_t &) noexcept { deallocate(pointer); }
+void operator delete[](void * pointer, const std::nothrow_t &) noexcept { deallocate(pointer); }
+void operator delete(void * pointer, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete[](void * pointer, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete(void * pointer, std::size_t, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete[](void * pointer, std::size_t, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete(void * pointer, std::align_val_t, const std::nothrow_t &) noexcept { deallocate(pointer); }
+void operator delete[](void * pointer, std::align_val_t, const std::nothrow_t &) noexcept { deallocate(pointer); }
@@ -0,0 +1,41 @@
+#pragma once
+
+/**
+ * Counts heap allocations of the current thread. Linking `allocation_counter.cpp` replaces the
+ * global `operator new` and `operator delete` with versions that update the counters.
+ * Usage:
+ *   AllocationCounter counter;
+ *   for (auto v: range(10)) { ... }
+ *   assert(counter.allocations() == 0);
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace easy_iterator {
+
+  struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes = 0;
+  };
+
+  /**
+   * Returns the number of allocations made by the current thread since it was started.
+   */
+  AllocationCounts currentAllocationCounts();
+
+  /**
+   * Counts the allocations of the current thread since construction or the last call to `reset()`.
+   */
+  class AllocationCounter {
+    AllocationCounts start;
+  public:
+    AllocationCounter():start(currentAllocationCounts()){ }
+    void reset(){ start = currentAllocationCounts(); }
+    uint64_t allocations()const{ return currentAllocationCounts().allocations - start.allocations; }
+    uint64_t deallocations()const{ return currentAllocationCounts().deallocations - start.deallocations; }
+    uint64_t bytes()const{ return currentAllocationCounts().bytes - start.bytes; }
+  };
+
+}
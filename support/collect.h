@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * Test helper that copies the values of an iterable into a vector.
+ * Usage:
+ *   REQUIRE(collect(range(3)) == std::vector<int>{0, 1, 2});
+ */
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace easy_iterator {
+
+  /**
+   * Returns a vector with copies of the values of `iterable`.
+   */
+  template <class T> std::vector<std::decay_t<decltype(*std::declval<T>().begin())>> collect(T && iterable) {
+    std::vector<std::decay_t<decltype(*std::declval<T>().begin())>> result;
+    for (auto &&v: iterable) { result.push_back(v); }
+    return result;
+  }
+
+}
@@ -0,0 +1,115 @@
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/bitpacked.h>
+#include <easy_iterator/shard.h>
+
+using namespace easy_iterator;
+
+namespace {
+
+  std::vector<uint64_t> randomValues(size_t count, unsigned bits) {
+    std::mt19937_64 engine(bits);
+    std::vector<uint64_t> values;
+    for (auto i: range(count)) {
+      (void)i;
+      values.push_back(engine() & bitpacked_detail::mask(bits));
+    }
+    return values;
+  }
+
+  template <class T> std::vector<uint64_t> collect(T && iterable) {
+    std::vector<uint64_t> result;
+    for (auto v: iterable) { result.push_back(v); }
+    return result;
+  }
+
+}
+
+TEST_CASE("bitpacked", "[bitpacked]"){
+
+  SECTION("layout"){
+    auto packed = pack_bits<4>(std::vector<int>{1, 2, 3, 15});
+    REQUIRE(packed.size == 4);
+    REQUIRE(packed.words == std::vector<uint64_t>{0xf321});
+    REQUIRE(pack_bits<3>(range(22)).words.size() == 2);
+    REQUIRE(pack_bits<2>(std::vector<int>{7}).words == std::vector<uint64_t>{3});
+  }
+
+  SECTION("compile-time width"){
+    auto values = randomValues(1000, 12);
+    auto packed = pack_bits<12>(values);
+    REQUIRE(packed.words.size() == (1000 * 12 + 63) / 64);
+    auto view = bitpacked<12>(packed);
+    static_assert(std::is_same<decltype(view[0]), uint32_t>::value);
+    REQUIRE(view.size() == 1000);
+    for (auto i: range(values.size())) { REQUIRE(view[i] == values[i]); }
+    REQUIRE(collect(view) == values);
+    REQUIRE(collect(view.scan()) == values);
+  }
+
+  SECTION("runtime width"){
+    for (unsigned bits: {1u, 2u, 3u, 5u, 7u, 8u, 10u, 12u, 13u, 14u, 16u, 17u, 24u, 25u, 26u, 31u, 32u, 33u, 63u, 64u}) {
+      for (size_t count: {0, 1, 63, 64, 65, 200}) {
+        auto values = randomValues(count, bits);
+        auto packed = pack_bits(values, bits);
+        auto view = bitpacked(packed);
+        REQUIRE(view.bits() == bits);
+        REQUIRE(collect(view) == values);
+        REQUIRE(collect(view.scan()) == values);
+        std::vector<uint64_t> unpacked(count > 10 ? count - 10 : 0);
+        view.unpack(count > 10 ? 5 : 0, unpacked.size(), unpacked.data());
+        REQUIRE(std::equal(unpacked.begin(), unpacked.end(), values.begin() + (count > 10 ? 5 : 0)));
+      }
+    }
+  }
+
+  SECTION("invalid width"){
+    std::vector<uint64_t> words(4);
+    REQUIRE_THROWS_AS(bitpacked(words, 64, 0), std::invalid_argument);
+    REQUIRE_THROWS_AS(bitpacked(words, 1, 65), std::invalid_argument);
+    REQUIRE_THROWS_AS(pack_bits(std::vector<int>{1}, 0), std::invalid_argument);
+    REQUIRE_THROWS_AS(pack_bits(std::vector<int>{1}, 65), std::invalid_argument);
+    PackedBits empty;
+    REQUIRE_THROWS_AS(bitpacked(empty), std::invalid_argument);
+    auto packed = pack_bits(std::vector<int>{1, 2, 3}, 10);
+    REQUIRE_THROWS_AS(bitpacked<12>(packed), std::invalid_argument);
+    REQUIRE(bitpacked<10>(packed)[2] == 3);
+  }
+
+  SECTION("random access"){
+    auto values = randomValues(500, 10);
+    auto packed = pack_bits<10>(values);
+    auto view = bitpacked<10>(packed.words, packed.size);
+    auto it = view.begin() + 100;
+    REQUIRE(*it == values[100]);
+    REQUIRE(it[5] == values[105]);
+    REQUIRE(view.end() - it == 400);
+    std::vector<uint64_t> sorted(view.begin(), view.end());
+    std::sort(sorted.begin(), sorted.end());
+    REQUIRE(std::is_sorted(sorted.begin(), sorted.end()));
+    REQUIRE(collect(shard(view, 1, 2)) == std::vector<uint64_t>(values.begin() + 250, values.end()));
+  }
+
+  SECTION("zip with a temporary view"){
+    auto values = randomValues(300, 12);
+    auto packed = pack_bits<12>(values);
+    size_t index = 0;
+    for (auto [code, value]: zip(bitpacked<12>(packed), values)) {
+      REQUIRE(code == value);
+      ++index;
+    }
+    REQUIRE(index == values.size());
+    index = 0;
+    for (auto [code, value]: zip(bitpacked(packed.words, packed.size, 12), values)) {
+      REQUIRE(code == value);
+      ++index;
+    }
+    REQUIRE(index == values.size());
+  }
+}
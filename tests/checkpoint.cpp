@@ -0,0 +1,248 @@
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/checkpoint.h>
+#include <easy_iterator/stepper.h>
+#include <collect.h>
+
+using namespace easy_iterator;
+
+namespace {
+
+  struct Fibonacci {
+    uint64_t a = 0, b = 1;
+    bool advance(){ auto next = a + b; a = b; b = next; return true; }
+    uint64_t value(){ return a; }
+  };
+
+  /**
+   * A generator with checkpoint and skip hooks.
+   */
+  struct Counter {
+    uint64_t current = 0, end = 100;
+    bool advance(){ return ++current < end; }
+    uint64_t value(){ return current; }
+    uint64_t checkpoint() const { return current; }
+    void resume(uint64_t state){ current = state; }
+    std::pair<bool, size_t> skip(size_t n){
+      auto skipped = std::min<uint64_t>(n, end - current);
+      current += skipped;
+      return std::make_pair(current < end, static_cast<size_t>(skipped));
+    }
+  };
+
+}
+
+TEST_CASE("checkpoint", "[checkpoint]"){
+
+  SECTION("range"){
+    auto iterable = range(10, 30, 2);
+    auto it = iterable.begin();
+    ++it; ++it;
+    auto state = checkpoint(it);
+    static_assert(std::is_same<decltype(state), int>::value);
+    REQUIRE(state == 14);
+    REQUIRE(collect(resume(range(10, 30, 2), state)) == std::vector<int>{14, 16, 18, 20, 22, 24, 26, 28});
+  }
+
+  SECTION("MakeIterable"){
+    auto iterable = MakeIterable<Fibonacci>();
+    auto it = iterable.begin();
+    for (auto i: range(10)) { (void)i; ++it; }
+    REQUIRE(*it == 55);
+    auto state = checkpoint(it);
+    std::vector<uint64_t> values;
+    for (auto v: resume(MakeIterable<Fibonacci>(), state)) {
+      values.push_back(v);
+      if (values.size() == 3) { break; }
+    }
+    REQUIRE(values == std::vector<uint64_t>{55, 89, 144});
+  }
+
+  SECTION("checkpoint hook"){
+    auto iterable = MakeIterable<Counter>();
+    auto it = iterable.begin();
+    ++it; ++it; ++it;
+    auto state = checkpoint(it);
+    REQUIRE(state.value == 3);
+    REQUIRE(state.valid);
+    REQUIRE(collect(resume(MakeIterable<Counter>(), state)).size() == 97);
+  }
+
+  SECTION("exhausted generator"){
+    auto iterable = MakeIterable<Counter>();
+    auto it = iterable.begin();
+    while (it != IterationEnd()) { ++it; }
+    REQUIRE(!checkpoint(it).valid);
+    REQUIRE(collect(resume(MakeIterable<Counter>(), checkpoint(it))).empty());
+  }
+
+  SECTION("zip"){
+    auto iterable = zip(range(5), range(10, 15), MakeIterable<Fibonacci>());
+    auto it = iterable.begin();
+    ++it; ++it;
+    auto state = checkpoint(it);
+    REQUIRE(std::get<0>(state) == 2);
+    REQUIRE(std::get<1>(state) == 12);
+    std::vector<int> first, second;
+    std::vector<uint64_t> third;
+    for (auto [a, b, c]: resume(zip(range(5), range(10, 15), MakeIterable<Fibonacci>()), state)) {
+      first.push_back(a);
+      second.push_back(b);
+      third.push_back(c);
+      if (first.size() == 2) { break; }
+    }
+    REQUIRE(first == std::vector<int>{2, 3});
+    REQUIRE(second == std::vector<int>{12, 13});
+    REQUIRE(third == std::vector<uint64_t>{1, 2});
+  }
+
+  SECTION("enumerate and containers"){
+    std::vector<int> values{5, 6, 7, 8, 9};
+    std::vector<int> doubled{10, 12, 14, 16, 18};
+    auto enumerated = enumerate(values);
+    auto begin = enumerated.begin();
+    auto it = begin;
+    ++it; ++it;
+    auto state = checkpoint(it, begin);
+    REQUIRE(std::get<0>(state) == 2);
+    REQUIRE(std::get<1>(state) == 2);
+    std::vector<int> indices, result;
+    for (auto [i, v]: resume(enumerate(values), state)) { indices.push_back(i); result.push_back(v); }
+    REQUIRE(indices == std::vector<int>{2, 3, 4});
+    REQUIRE(result == std::vector<int>{7, 8, 9});
+
+    auto zipped = zip(values, doubled);
+    auto zipBegin = zipped.begin();
+    auto zipIt = zipBegin;
+    ++zipIt; ++zipIt; ++zipIt;
+    auto zipState = checkpoint(zipIt, zipBegin);
+    result.clear();
+    for (auto [a, b]: resume(zip(values, doubled), zipState)) { result.push_back(b - a); }
+    REQUIRE(result == std::vector<int>{8, 9});
+  }
+
+  SECTION("serialization"){
+    auto iterable = zip(range(5), range(10, 15));
+    auto it = iterable.begin();
+    ++it;
+    std::vector<int> stored;
+    for_each_element(checkpoint(it), [&](int v){ stored.push_back(v); });
+    REQUIRE(stored == std::vector<int>{1, 11});
+    CheckpointState<decltype(it)> loaded;
+    auto next = stored.begin();
+    for_each_element(loaded, [&](int &v){ v = *next++; });
+    REQUIRE(collect(resume(zip(range(5), range(10, 15)), loaded)).size() == 4);
+  }
+}
+
+TEST_CASE("skip", "[checkpoint]"){
+
+  SECTION("range"){
+    REQUIRE(collect(skip(range(10), 7)) == std::vector<int>{7, 8, 9});
+    REQUIRE(collect(skip(range(10, 0, -3), 1)) == std::vector<int>{7, 4});
+    REQUIRE(collect(skip(range(10), 20)).empty());
+    REQUIRE(collect(skip(range(10), 0)).size() == 10);
+  }
+
+  SECTION("containers"){
+    std::vector<int> values{1, 2, 3, 4, 5};
+    REQUIRE(collect(skip(values, 3)) == std::vector<int>{4, 5});
+    REQUIRE(collect(skip(values, 30)).empty());
+  }
+
+  SECTION("zip"){
+    std::vector<int> values{1, 2, 3, 4, 5};
+    std::vector<int> result;
+    for (auto [i, v]: skip(zip(range(5), values), 3)) { result.push_back(i * v); }
+    REQUIRE(result == std::vector<int>{12, 20});
+    REQUIRE(collect(skip(zip(range(100), values), 10)).empty());
+  }
+
+  SECTION("enumerate"){
+    std::vector<int> values{5, 6, 7, 8, 9};
+    std::vector<int> indices, result;
+    for (auto [i, v]: skip(enumerate(values), 2)) { indices.push_back(i); result.push_back(v); }
+    REQUIRE(indices == std::vector<int>{2, 3, 4});
+    REQUIRE(result == std::vector<int>{7, 8, 9});
+    REQUIRE(collect(skip(enumerate(values), 10)).empty());
+    auto scan = stepper(enumerate(values));
+    REQUIRE(scan.skip(3) == 3);
+    indices.clear();
+    scan.run_for(10, [&](auto pair){ indices.push_back(std::get<0>(pair)); });
+    REQUIRE(indices == std::vector<int>{3, 4});
+  }
+
+  SECTION("zip of containers"){
+    std::vector<int> values{1, 2, 3, 4, 5};
+    std::vector<int> squares{1, 4, 9, 16, 25};
+    std::vector<int> result;
+    for (auto [v, s]: skip(zip(values, squares), 3)) { result.push_back(s / v); }
+    REQUIRE(result == std::vector<int>{4, 5});
+    REQUIRE(collect(skip(zip(values, squares), 7)).empty());
+  }
+
+  SECTION("generators"){
+    REQUIRE(collect(skip(MakeIterable<Counter>(), 95)) == std::vector<uint64_t>{95, 96, 97, 98, 99});
+    REQUIRE(collect(skip(MakeIterable<Counter>(), 200)).empty());
+    auto it = MakeIterable<Counter>().begin();
+    REQUIRE(checkpoint_detail::skip(it, IterationEnd(), 200) == 100);
+    REQUIRE(checkpoint_detail::skip(it, IterationEnd(), 5) == 0);
+    auto partial = MakeIterable<Counter>().begin();
+    REQUIRE(checkpoint_detail::skip(partial, IterationEnd(), 100) == 100);
+    REQUIRE(!(partial != IterationEnd()));
+    std::vector<uint64_t> fibonacci;
+    for (auto v: skip(MakeIterable<Fibonacci>(), 10)) { fibonacci.push_back(v); if (fibonacci.size() == 2) { break; } }
+    REQUIRE(fibonacci == std::vector<uint64_t>{55, 89});
+  }
+}
+
+TEST_CASE("stepper checkpoint", "[checkpoint]"){
+  std::vector<int> visited;
+  auto first = stepper(zip(range(100), range(100, 200)), [&](auto v){ visited.push_back(std::get<0>(v)); });
+  first.run_for(10);
+  auto state = first.checkpoint();
+
+  // a new process resumes from the stored state
+  auto second = stepper(zip(range(100), range(100, 200)), [&](auto v){ visited.push_back(std::get<0>(v)); });
+  second.resume(state);
+  REQUIRE(second.position() == 10);
+  second.run_for(5);
+  REQUIRE(second.position() == 15);
+  REQUIRE(visited == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14});
+
+  std::vector<int> values{5, 6, 7, 8};
+  std::vector<int> seen;
+  auto vectorStepper = stepper(values, [&](int v){ seen.push_back(v); });
+  vectorStepper.run_for(3);
+  auto vectorState = vectorStepper.checkpoint();
+  REQUIRE(vectorState.position == 3);
+  REQUIRE(vectorState.iterator == 3);
+  auto resumed = stepper(values, [&](int v){ seen.push_back(v); });
+  resumed.resume(vectorState);
+  resumed.run_for(10);
+  REQUIRE(resumed.position() == 4);
+  REQUIRE(seen == values);
+
+  auto third = stepper(range(100), [&](int v){ visited.push_back(v); });
+  REQUIRE(third.skip(98) == 98);
+  REQUIRE(third.position() == 98);
+  third.run_for(10);
+  REQUIRE(third.done());
+  REQUIRE(visited.back() == 99);
+
+  auto counter = stepper(MakeIterable<Counter>());
+  REQUIRE(counter.skip(150) == 100);
+  REQUIRE(counter.position() == 100);
+  REQUIRE(counter.done());
+
+  std::vector<int> zipped;
+  for (auto [i, v]: skip(zip(range(1000), MakeIterable<Counter>()), 150)) { zipped.push_back(i + static_cast<int>(v)); }
+  REQUIRE(zipped.empty());
+  auto zipStepper = stepper(zip(range(1000), MakeIterable<Counter>()));
+  REQUIRE(zipStepper.skip(150) == 100);
+}
@@ -0,0 +1,138 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/columnar.h>
+
+using namespace easy_iterator;
+
+namespace {
+
+  struct TemporaryFile {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "easy_iterator_columnar_test.col";
+    ~TemporaryFile() { std::filesystem::remove(path); }
+  };
+
+}
+
+TEST_CASE("columnar file", "[columnar]"){
+  TemporaryFile file;
+  std::vector<uint64_t> ids;
+  std::vector<double> prices;
+  std::vector<int16_t> deltas;
+  for (auto i: range(uint64_t(1000))) {
+    ids.push_back(i);
+    prices.push_back(0.5 * static_cast<double>(i));
+    deltas.push_back(static_cast<int16_t>(i % 7) - 3);
+  }
+  REQUIRE(write_columns(file.path, zip(ids, prices, deltas), 100) == 1000);
+
+  SECTION("read"){
+    ColumnarFile columns(file.path);
+    REQUIRE(columns.rows() == 1000);
+    REQUIRE(columns.columns() == 3);
+    REQUIRE(columns.blocks() == 10);
+    auto view = columns.column<double>(1);
+    REQUIRE(view.size() == 1000);
+    REQUIRE(view[10] == 5.0);
+    REQUIRE(reinterpret_cast<uintptr_t>(view.data()) % 64 == 0);
+    size_t index = 0;
+    for (auto [id, price, delta]: columns.read<uint64_t, double, int16_t>()) {
+      REQUIRE(id == ids[index]);
+      REQUIRE(price == prices[index]);
+      REQUIRE(delta == deltas[index]);
+      ++index;
+    }
+    REQUIRE(index == 1000);
+  }
+
+  SECTION("block statistics"){
+    ColumnarFile columns(file.path);
+    REQUIRE(columns.has_statistics(0));
+    REQUIRE(columns.block_min<uint64_t>(0, 3) == 300);
+    REQUIRE(columns.block_max<double>(1, 3) == 199.5);
+    REQUIRE(columns.block_min<int16_t>(2, 0) == -3);
+    auto selection = columns.read_where<1, uint64_t, double, int16_t>([](double min, double max){ return max >= 120 && min < 260; });
+    REQUIRE(selection.row_ranges() == std::vector<std::pair<size_t, size_t>>{{200, 600}});
+    std::vector<uint64_t> selected;
+    for (auto [id, price, delta]: selection) { (void)price; (void)delta; selected.push_back(id); }
+    REQUIRE(selected.size() == 400);
+    REQUIRE(selected.front() == 200);
+    REQUIRE(selected.back() == 599);
+
+    selected.clear();
+    for (auto [id, price, delta]: columns.read_where<0, uint64_t, double, int16_t>([](auto min, auto){ return min % 300 == 0; })) {
+      (void)price; (void)delta; selected.push_back(id);
+    }
+    REQUIRE(selected.size() == 400);
+    REQUIRE(selected[100] == 300);
+    REQUIRE(selected[399] == 999);
+    REQUIRE(columns.read_where<0, uint64_t, double, int16_t>([](auto, auto){ return false; }).row_ranges().empty());
+  }
+
+  SECTION("without statistics"){
+    std::vector<float> values{1.5f, 2.5f, 3.5f};
+    REQUIRE(write_columns(file.path, zip(values), 2, false) == 3);
+    ColumnarFile columns(file.path);
+    REQUIRE(!columns.has_statistics(0));
+    REQUIRE(columns.read_where<0, float>([](auto, auto){ return false; }).row_ranges().size() == 1);
+    REQUIRE_THROWS_AS(columns.block_min<float>(0, 0), ColumnarFileException);
+  }
+
+  SECTION("checkpoint and resume"){
+    CheckpointState<decltype(ColumnarFile(file.path).read<uint64_t, double, int16_t>().begin())> state;
+    {
+      ColumnarFile columns(file.path);
+      auto rows = columns.read<uint64_t, double, int16_t>();
+      auto it = rows.begin();
+      auto begin = it;
+      for (auto i: range(250)) { (void)i; ++it; }
+      state = checkpoint(it, begin);
+    }
+    ColumnarFile columns(file.path);
+    std::vector<uint64_t> resumed;
+    for (auto [id, price, delta]: resume(columns.read<uint64_t, double, int16_t>(), state)) {
+      REQUIRE(price == 0.5 * static_cast<double>(id));
+      (void)delta;
+      resumed.push_back(id);
+    }
+    REQUIRE(resumed == std::vector<uint64_t>(ids.begin() + 250, ids.end()));
+
+    auto selective = [](double min, double max){ return min >= 100 || max < 50; };
+    auto selection = columns.read_where<1, uint64_t, double, int16_t>(selective);
+    auto it = selection.begin();
+    for (auto i: range(120)) { (void)i; ++it; }
+    auto rowState = checkpoint(it);
+    REQUIRE(rowState == 220);
+    std::vector<uint64_t> rest;
+    for (auto [id, price, delta]: resume(columns.read_where<1, uint64_t, double, int16_t>(selective), rowState)) {
+      (void)price; (void)delta;
+      rest.push_back(id);
+    }
+    REQUIRE(rest == std::vector<uint64_t>(ids.begin() + 220, ids.end()));
+    auto fromGap = resume(columns.read_where<1, uint64_t, double, int16_t>(selective), size_t(150));
+    REQUIRE(std::get<0>(*fromGap.begin()) == 200);
+  }
+
+  SECTION("schema errors"){
+    ColumnarFile columns(file.path);
+    REQUIRE_THROWS_AS(columns.column<float>(1), ColumnarFileException);
+    REQUIRE_THROWS_AS(columns.column<uint64_t>(3), ColumnarFileException);
+    REQUIRE_THROWS_AS((columns.read<uint64_t, double>()), ColumnarFileException);
+    std::ofstream(file.path) << "not a columnar file at all, but long enough to hold a header";
+    REQUIRE_THROWS_AS(ColumnarFile(file.path), ColumnarFileException);
+  }
+
+  SECTION("writer"){
+    ColumnWriter<int32_t, uint8_t> writer(file.path, 4);
+    for (auto i: range(10)) { writer.push(i, static_cast<uint8_t>(i * 2)); }
+    REQUIRE(writer.close() == 10);
+    ColumnarFile columns(file.path);
+    REQUIRE(columns.blocks() == 3);
+    REQUIRE(columns.block_max<uint8_t>(1, 2) == 18);
+    REQUIRE(columns.column<int32_t>(0)[9] == 9);
+  }
+}
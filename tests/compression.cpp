@@ -0,0 +1,93 @@
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/compression.h>
+#include <collect.h>
+
+using namespace easy_iterator;
+
+namespace {
+
+  /**
+   * Values with mixed byte lengths, mostly small.
+   */
+  std::vector<uint32_t> mixedValues(size_t count) {
+    std::mt19937 engine(7);
+    std::vector<uint32_t> values;
+    for (auto i: range(count)) {
+      (void)i;
+      auto bits = engine() % 33;
+      values.push_back(bits < 20 ? engine() % 100 : static_cast<uint32_t>(engine() >> (32 - bits)));
+    }
+    return values;
+  }
+
+}
+
+TEST_CASE("delta coding", "[compression]"){
+  std::vector<uint32_t> values{3, 7, 7, 20, 100};
+  REQUIRE(collect(delta_encode(values)) == std::vector<uint32_t>{3, 4, 0, 13, 80});
+  REQUIRE(collect(delta_decode(delta_encode(values))) == values);
+  REQUIRE(collect(delta_decode(std::vector<int64_t>{5, -2, -2})) == std::vector<int64_t>{5, 3, 1});
+  REQUIRE(collect(delta_decode(std::vector<uint32_t>())).empty());
+
+  std::vector<uint32_t> sorted;
+  for (auto i: range(1000u)) { sorted.push_back(i * i); }
+  REQUIRE(collect(delta_decode(delta_encode(sorted))) == sorted);
+  REQUIRE(collect(delta_decode(delta_encode(range(0, 300, 3)))) == collect(range(0, 300, 3)));
+}
+
+TEST_CASE("varint coding", "[compression]"){
+  REQUIRE(varint_encode(std::vector<uint32_t>{1, 127, 128, 300}) == std::vector<uint8_t>{1, 127, 0x80, 1, 0xac, 2});
+  REQUIRE(collect(varint_decode(std::vector<uint8_t>{1, 127, 0x80, 1, 0xac, 2})) == std::vector<uint32_t>{1, 127, 128, 300});
+
+  auto values = mixedValues(5000);
+  auto bytes = varint_encode(values);
+  REQUIRE(collect(varint_decode(bytes)) == values);
+
+  std::vector<uint64_t> large{0, 1, uint64_t(1) << 40, ~uint64_t(0)};
+  REQUIRE(collect(varint_decode<uint64_t>(varint_encode(large))) == large);
+
+  std::vector<uint32_t> small(1000, 5);
+  REQUIRE(varint_encode(small).size() == 1000);
+  REQUIRE(collect(varint_decode(varint_encode(small))) == small);
+
+  std::vector<uint32_t> postings;
+  for (auto i: range(2000u)) { postings.push_back(i * 3 + (i % 7) * 1000); }
+  std::sort(postings.begin(), postings.end());
+  REQUIRE(collect(delta_decode(varint_decode(varint_encode(delta_encode(postings))))) == postings);
+
+  REQUIRE_THROWS_AS(collect(varint_decode(std::vector<uint8_t>{1, 0x80})), DecodeException);
+
+  SECTION("signed values"){
+    std::vector<int32_t> small{0, -1, 1, -64, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()};
+    for (auto i: range(1000)) { small.push_back(i * -7919); }
+    REQUIRE(collect(varint_decode<int32_t>(varint_encode(small))) == small);
+    std::vector<int64_t> large{-1, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()};
+    for (auto i: range(1000)) { large.push_back(int64_t(i) * -1000000007LL); }
+    REQUIRE(collect(varint_decode<int64_t>(varint_encode(large))) == large);
+  }
+}
+
+TEST_CASE("StreamVByte coding", "[compression]"){
+  auto encoded = svb_encode(std::vector<uint32_t>{1, 256, 65536, 16777216, 7});
+  REQUIRE(encoded.count == 5);
+  REQUIRE(encoded.control == std::vector<uint8_t>{0b11100100, 0});
+  REQUIRE(encoded.data.size() == 1 + 2 + 3 + 4 + 1);
+  REQUIRE(collect(svb_decode(encoded)) == std::vector<uint32_t>{1, 256, 65536, 16777216, 7});
+
+  for (size_t count: {0, 1, 3, 4, 63, 64, 65, 1001}) {
+    auto values = mixedValues(count);
+    auto result = svb_encode(values);
+    REQUIRE(collect(svb_decode(result.control, result.data, result.count)) == values);
+  }
+
+  std::vector<uint8_t> control{0xff}, data{1, 2, 3};
+  REQUIRE_THROWS_AS(collect(svb_decode(control, data, 4)), DecodeException);
+  REQUIRE_THROWS_AS(svb_decode(control, data, 5), DecodeException);
+}
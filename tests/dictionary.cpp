@@ -0,0 +1,75 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/dictionary.h>
+#include <collect.h>
+
+using namespace easy_iterator;
+
+namespace {
+
+  template <class T, class P> std::vector<size_t> expectedRows(const std::vector<T> &values, P && predicate) {
+    std::vector<size_t> rows;
+    for (auto i: range(values.size())) {
+      if (predicate(values[i])) { rows.push_back(i); }
+    }
+    return rows;
+  }
+
+}
+
+TEST_CASE("dictionary column", "[dictionary]"){
+  std::vector<std::string> dictionary{"berlin", "paris", "rome"};
+  std::vector<uint8_t> codes{2, 0, 0, 1, 2};
+  auto column = dict_column(dictionary, codes);
+  REQUIRE(collect(column) == std::vector<std::string>{"rome", "berlin", "berlin", "paris", "rome"});
+  REQUIRE(count_if(column, [](const std::string &city){ return city == "berlin"; }) == 2);
+  REQUIRE(count_if(column, [](const std::string &city){ return city == "london"; }) == 0);
+  REQUIRE(matching_rows(column, [](const std::string &city){ return city != "paris"; }) == std::vector<size_t>{0, 1, 2, 4});
+  REQUIRE(collect(filter(column, [](const std::string &city){ return city[0] == 'r'; })) == std::vector<std::string>{"rome", "rome"});
+  REQUIRE(collect(dict_column(std::vector<int>{}, std::vector<uint32_t>{})).empty());
+  REQUIRE(collect(dict_column(dictionary, std::list<int>{1, 1})) == std::vector<std::string>{"paris", "paris"});
+  REQUIRE(count_if(dict_column(dictionary, std::list<int>{1, 2, 1}), [](const std::string &city){ return city == "paris"; }) == 2);
+}
+
+TEST_CASE("dictionary encoding", "[dictionary]"){
+  std::vector<int> values;
+  for (auto i: range(1000)) { values.push_back((i * 37) % 101); }
+  auto encoded = dict_encode(values);
+  REQUIRE(encoded.dictionary().size() == 101);
+  REQUIRE(std::is_sorted(encoded.dictionary().begin(), encoded.dictionary().end()));
+  REQUIRE(collect(encoded) == values);
+
+  auto range = [](int v){ return v >= 20 && v < 70; };
+  auto sparse = [](int v){ return v % 7 == 3; };
+  REQUIRE(encoded.matcher(range).type() == CodeMatcher::Kind::range);
+  REQUIRE(encoded.matcher(sparse).type() == CodeMatcher::Kind::table);
+  for (auto predicate: std::vector<bool(*)(int)>{+[](int v){ return v >= 20 && v < 70; }, +[](int v){ return v % 7 == 3; }, +[](int v){ return v == 100; }, +[](int){ return true; }}) {
+    auto rows = expectedRows(values, predicate);
+    REQUIRE(count_if(encoded, predicate) == rows.size());
+    REQUIRE(matching_rows(encoded, predicate) == rows);
+    REQUIRE(collect(filter(encoded, predicate)).size() == rows.size());
+  }
+
+  SECTION("code overflow"){
+    REQUIRE_THROWS_AS(dict_encode<uint8_t>(easy_iterator::range(300)), std::length_error);
+    REQUIRE(collect(dict_encode<uint8_t>(easy_iterator::range(256))) == collect(easy_iterator::range(256)));
+  }
+
+  SECTION("code widths"){
+    auto narrow = dict_encode<uint8_t>(values);
+    auto wide = dict_encode<uint16_t>(values);
+    for (size_t count: {0, 1, 15, 16, 17, 999}) {
+      std::vector<int> prefix(values.begin(), values.begin() + count);
+      auto rows = expectedRows(prefix, range);
+      REQUIRE(matching_rows(dict_column(narrow.dictionary(), std::vector<uint8_t>(narrow.codes().begin(), narrow.codes().begin() + count)), range) == rows);
+      REQUIRE(matching_rows(dict_column(wide.dictionary(), std::vector<uint16_t>(wide.codes().begin(), wide.codes().begin() + count)), range) == rows);
+      REQUIRE(count_if(dict_column(narrow.dictionary(), std::vector<uint8_t>(narrow.codes().begin(), narrow.codes().begin() + count)), range) == rows.size());
+    }
+  }
+}
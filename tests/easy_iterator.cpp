@@ -4,8 +4,11 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <array>
+#include <tuple>
 
 #include <easy_iterator.h>
+#include <allocation_counter.h>
 
 using namespace easy_iterator;
 
@@ -39,6 +42,19 @@ TEST_CASE("IteratorPrototype","[iterator]"){
     }
     REQUIRE(expected == 3);
   }
+
+  SECTION("functionals"){
+    struct ScaledIterator: public IteratorPrototype<int, dereference::ByValue> {
+      using IteratorPrototype<int, dereference::ByValue>::IteratorPrototype;
+      ScaledIterator & operator++() { ++value; return *this; }
+      int scaled() { return dereferencer(value) * 2; }
+      bool same(const ScaledIterator &other) const { return compare(value, other.value) && compare()(value, other.value); }
+    };
+    ScaledIterator iterator(3);
+    REQUIRE(iterator.scaled() == 6);
+    REQUIRE(iterator.same(ScaledIterator(3)));
+    REQUIRE(!iterator.same(ScaledIterator(4)));
+  }
   
   SECTION("compare"){
     REQUIRE(CountDownIterator(1) == CountDownIterator(1));
@@ -345,3 +361,180 @@ TEST_CASE("found") {
   REQUIRE(&found(map.find("a"), map)->second == &map["a"]);
   REQUIRE(!found(map.find("c"), map));
 }
+
+TEST_CASE("for_each_element","[elements]"){
+
+  SECTION("tuple"){
+    std::tuple<int, double, std::string> t(1, 2.5, "three");
+    std::vector<std::string> visited;
+    for_each_element(t, [&](auto &v){
+      if constexpr (std::is_same<std::decay_t<decltype(v)>, std::string>::value) {
+        visited.push_back(v);
+      } else {
+        visited.push_back(std::to_string(v));
+      }
+    });
+    REQUIRE(visited == std::vector<std::string>{"1", "2.500000", "three"});
+  }
+
+  SECTION("array"){
+    std::array<int, 4> arr{1, 2, 3, 4};
+    int sum = 0;
+    for_each_element(arr, [&](int v){ sum += v; });
+    REQUIRE(sum == 10);
+  }
+
+  SECTION("aggregate"){
+    struct Record { int a; double b; std::string c; };
+    Record r{1, 2, "x"};
+    for_each_element(r, [](auto &v){ v = v + v; });
+    REQUIRE(r.a == 2);
+    REQUIRE(r.b == 4);
+    REQUIRE(r.c == "xx");
+    size_t count = 0;
+    for_each_element(std::as_const(r), [&](const auto &){ ++count; });
+    REQUIRE(count == 3);
+  }
+
+}
+
+TEST_CASE("zip_elements","[elements]"){
+
+  SECTION("tuples"){
+    std::tuple<int, double> a(1, 2.5), b(3, 0.5);
+    zip_elements(a, b, [](auto &x, const auto &y){ x += y; });
+    REQUIRE(std::get<0>(a) == 4);
+    REQUIRE(std::get<1>(a) == 3);
+  }
+
+  SECTION("aggregates"){
+    struct Stats { int count; double total; };
+    Stats total{0, 0}, sample{2, 1.5};
+    zip_elements(total, sample, [](auto &t, auto s){ t += s; });
+    zip_elements(total, std::make_tuple(1, 0.5), [](auto &t, auto s){ t += s; });
+    REQUIRE(total.count == 3);
+    REQUIRE(total.total == 2);
+  }
+
+}
+
+TEST_CASE("unroll","[iterator]"){
+
+  SECTION("random access"){
+    for (auto size: {0, 1, 3, 4, 5, 8, 11}) {
+      std::vector<int> values(size);
+      copy(range(size), values);
+      std::vector<int> visited;
+      unroll<4>(values, [&](int &v){ visited.push_back(v); v = -v; });
+      REQUIRE(visited == std::vector<int>(rangeValue(0), rangeValue(size)));
+      for (auto [i, v]: enumerate(values)) { REQUIRE(v == -i); }
+    }
+  }
+
+  SECTION("range"){
+    std::vector<int> visited;
+    unroll<3>(range(2, 20, 2), [&](int v){ visited.push_back(v); });
+    REQUIRE(visited == std::vector<int>{2, 4, 6, 8, 10, 12, 14, 16, 18});
+    visited.clear();
+    unroll<4>(range(10, 0, -3), [&](int v){ visited.push_back(v); });
+    REQUIRE(visited == std::vector<int>{10, 7, 4});
+  }
+
+  SECTION("fallback"){
+    std::map<int, int> map{{1, 2}, {3, 4}, {5, 6}};
+    int sum = 0;
+    unroll<2>(map, [&](auto &p){ sum += p.first * p.second; });
+    REQUIRE(sum == 2 + 12 + 30);
+    std::vector<int> values{1, 2, 3};
+    auto mixed = zip(map, values);
+    static_assert(!unroll_detail::IsOffsetZip<std::decay_t<decltype(mixed.begin())>, std::decay_t<decltype(mixed.end())>>::value);
+    sum = 0;
+    unroll<2>(zip(map, values), [&](auto v){ sum += std::get<0>(v).first * std::get<1>(v); });
+    REQUIRE(sum == 1 + 6 + 15);
+  }
+
+  SECTION("zip"){
+    for (auto size: {0, 1, 4, 5, 11}) {
+      std::vector<int> a(size), b(size);
+      copy(range(size), a);
+      auto zipped = zip(a, b);
+      static_assert(unroll_detail::IsOffsetZip<std::decay_t<decltype(zipped.begin())>, std::decay_t<decltype(zipped.end())>>::value);
+      unroll<2>(zip(a, b), [](auto v){ std::get<1>(v) = 2 * std::get<0>(v); });
+      for (auto [i, v]: enumerate(b)) { REQUIRE(v == 2 * i); }
+      std::vector<int> visited;
+      auto enumerated = enumerate(a);
+      static_assert(unroll_detail::IsOffsetZip<std::decay_t<decltype(enumerated.begin())>, std::decay_t<decltype(enumerated.end())>>::value);
+      unroll<4>(enumerate(a), [&](auto v){ REQUIRE(std::get<0>(v) == std::get<1>(v)); visited.push_back(std::get<0>(v)); });
+      REQUIRE(visited == std::vector<int>(rangeValue(0), rangeValue(size)));
+    }
+  }
+
+}
+
+TEST_CASE("iterator size","[iterator]"){
+
+  SECTION("ReferenceIterator"){
+    static_assert(sizeof(ReferenceIterator<int>) == sizeof(int *));
+    static_assert(sizeof(ReferenceIterator<const double>) == sizeof(const double *));
+  }
+
+  SECTION("range"){
+    static_assert(sizeof(RangeIterator<int>) == 2 * sizeof(int));
+    static_assert(sizeof(range(10).begin()) == 2 * sizeof(int));
+  }
+
+  SECTION("zip"){
+    std::vector<int> a;
+    std::vector<double> b;
+    static_assert(sizeof(zip(a, b).begin()) == sizeof(a.begin()) + sizeof(b.begin()));
+    static_assert(sizeof(zip(range(10), range(10)).begin()) == 4 * sizeof(int));
+    static_assert(sizeof(zip(zip(a, b), a).begin()) == 3 * sizeof(a.begin()));
+    static_assert(sizeof(zip(a, zip(a, b)).begin()) == 3 * sizeof(a.begin()));
+    static_assert(sizeof(enumerate(zip(a, b)).begin()) == 2 * sizeof(int) + 2 * sizeof(a.begin()));
+  }
+
+  SECTION("enumerate"){
+    std::vector<int> a;
+    static_assert(sizeof(enumerate(a).begin()) == 2 * sizeof(int) + sizeof(a.begin()));
+  }
+
+}
+
+TEST_CASE("allocations","[iterator]"){
+  std::vector<int> a(10), b(10);
+  std::map<int, int> map{{1, 2}};
+  std::tuple<int, double> tuple(1, 2);
+
+  struct Countdown {
+    unsigned current = 10;
+    bool advance() { return current-- > 0; }
+    unsigned value() { return current; }
+  };
+
+  AllocationCounter counter;
+  long sum = 0;
+  for (auto i: range(10)) { sum += i; }
+  for (auto i: range(2, 10, 2)) { sum += i; }
+  for (auto [i, j]: zip(a, b)) { sum += i + j; }
+  for (auto [i, v]: enumerate(a)) { sum += i + v; }
+  for (auto v: MakeIterable<Countdown>()) { sum += v; }
+  for (auto &v: valuesBetween(a.data(), a.data() + a.size())) { sum += v; }
+  for (auto v: reverse(a)) { sum += v; }
+  unroll<4>(a, [&](int v){ sum += v; });
+  unroll<4>(range(10), [&](int v){ sum += v; });
+  for_each_element(tuple, [&](auto v){ sum += static_cast<long>(v); });
+  zip_elements(tuple, tuple, [&](auto x, auto y){ sum += static_cast<long>(x * y); });
+  copy(range(10), a);
+  easy_iterator::copy(a, b, [](int v){ return 2 * v; });
+  easy_iterator::fill(a, 1);
+  if (auto v = found(map.find(1), map)) { sum += v->second; }
+  auto allocations = counter.allocations();
+
+  REQUIRE(sum != 0);
+  REQUIRE(allocations == 0);
+
+  counter.reset();
+  std::vector<int> allocating(10);
+  REQUIRE(counter.allocations() == 1);
+  REQUIRE(counter.bytes() == 10 * sizeof(int));
+}
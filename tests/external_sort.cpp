@@ -0,0 +1,86 @@
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/external_sort.h>
+#include <collect.h>
+
+using namespace easy_iterator;
+
+namespace {
+
+  struct Record {
+    uint32_t key;
+    uint32_t payload;
+  };
+
+  struct Random {
+    std::mt19937_64 engine{42};
+    size_t remaining;
+    explicit Random(size_t count):remaining(count){ }
+    bool advance(){ return remaining-- > 0; }
+    uint64_t value(){ return engine() % 1000; }
+  };
+
+}
+
+TEST_CASE("external sort", "[external_sort]"){
+  auto directory = std::filesystem::temp_directory_path();
+
+  SECTION("in memory"){
+    std::vector<int> values{5, 3, 9, 1, 1, 7};
+    auto sorted = external_sort(values);
+    REQUIRE(sorted.files().empty());
+    REQUIRE(collect(sorted) == std::vector<int>{1, 1, 3, 5, 7, 9});
+    REQUIRE(collect(external_sort(std::vector<int>())).empty());
+  }
+
+  SECTION("spilled runs"){
+    std::vector<uint64_t> expected;
+    for (auto v: MakeIterable<Random>(100000)) { expected.push_back(v); }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<std::filesystem::path> files;
+    {
+      auto sorted = external_sort(MakeIterable<Random>(100000), std::less<>(), 8 * 14000, directory);
+      files = sorted.files();
+      REQUIRE(files.size() == 15);
+      for (auto &file: files) { REQUIRE(std::filesystem::exists(file)); }
+      REQUIRE(collect(sorted) == expected);
+    }
+    for (auto &file: files) { REQUIRE(!std::filesystem::exists(file)); }
+  }
+
+  SECTION("comparator"){
+    std::vector<Record> records;
+    for (auto i: range(uint32_t(1000))) { records.push_back(Record{(i * 7919) % 1000, i}); }
+    auto sorted = external_sort(records, [](const Record &a, const Record &b){ return a.key > b.key; }, 8 * 128, directory);
+    REQUIRE(sorted.files().size() == 16);
+    uint32_t expectedKey = 1000;
+    for (auto &record: sorted) {
+      REQUIRE(record.key == --expectedKey);
+      REQUIRE((record.payload * 7919) % 1000 == record.key);
+    }
+    REQUIRE(expectedKey == 0);
+  }
+
+  SECTION("parallel run sort"){
+    std::vector<uint32_t> values;
+    std::mt19937 engine(1);
+    for (auto i: range(300000)) { (void)i; values.push_back(engine()); }
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(collect(external_sort(values)) == expected);
+    REQUIRE(collect(external_sort(values, std::less<>(), 4 * 200000, directory)) == expected);
+  }
+
+  SECTION("errors"){
+    std::vector<int> values{3, 2, 1};
+    REQUIRE_THROWS_AS(external_sort(values, std::less<>(), 4, directory / "easy_iterator_missing"), ExternalSortException);
+  }
+}
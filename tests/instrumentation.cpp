@@ -0,0 +1,115 @@
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/instrumentation.h>
+#include <allocation_counter.h>
+
+using namespace easy_iterator;
+using instrumentation::Histogram;
+using instrumentation::LoopStats;
+using instrumentation::Registry;
+
+TEST_CASE("Histogram", "[instrumentation]"){
+  SECTION("buckets"){
+    for (uint64_t v = 0; v < 100000; v += 1 + v / 16) {
+      auto index = Histogram::bucketIndex(v);
+      REQUIRE(index < Histogram::bucketCount);
+      REQUIRE(Histogram::bucketLowerBound(index) <= v);
+      REQUIRE(Histogram::bucketLowerBound(index + 1) > v);
+    }
+    REQUIRE(Histogram::bucketIndex(7) == 7);
+    REQUIRE(Histogram::bucketIndex(8) == 8);
+    REQUIRE(Histogram::bucketIndex(16) == 16);
+    REQUIRE(Histogram::bucketIndex(~uint64_t(0)) == Histogram::bucketCount - 1);
+  }
+
+  SECTION("percentiles"){
+    Histogram histogram;
+    REQUIRE(histogram.percentile(0.5) == 0);
+    for (auto i: range(1, 101)) { histogram.record(static_cast<uint64_t>(i)); }
+    REQUIRE(histogram.count() == 100);
+    REQUIRE(histogram.sum() == 5050);
+    REQUIRE(histogram.percentile(0) == 1);
+    REQUIRE(histogram.percentile(0.5) == Histogram::bucketLowerBound(Histogram::bucketIndex(50)));
+    REQUIRE(histogram.percentile(1) == Histogram::bucketLowerBound(Histogram::bucketIndex(100)));
+    histogram.reset();
+    REQUIRE(histogram.count() == 0);
+  }
+}
+
+TEST_CASE("instrumented", "[instrumentation]"){
+  std::vector<int> values{1, 2, 3, 4, 5};
+
+  SECTION("disabled"){
+    static_assert(std::is_same<decltype(instrumented<false>("disabled", values)), std::vector<int> &>::value);
+    static_assert(std::is_same<decltype(instrumented<false>("disabled", range(3))), decltype(range(3))>::value);
+    int sum = 0;
+    for (auto v: instrumented<false>("disabled", range(4))) { sum += v; }
+    REQUIRE(sum == 6);
+    bool registered = false;
+    Registry::global().forEach([&](const LoopStats &stats){ registered |= stats.name == "disabled"; });
+    REQUIRE(!registered);
+  }
+
+  SECTION("counting"){
+    auto &stats = Registry::global().get("counting");
+    stats.reset();
+    int sum = 0;
+    for (auto &v: instrumented<true>("counting", values)) { sum += v; v = 0; }
+    REQUIRE(sum == 15);
+    REQUIRE(values == std::vector<int>(5, 0));
+    for (auto i: instrumented<true>(stats, range(10))) { if (i == 3) { break; } }
+    for (auto i: instrumented<true>(stats, range(0))) { (void)i; }
+    REQUIRE(stats.invocations == 3);
+    REQUIRE(stats.elements == 9);
+    REQUIRE(stats.latencyNs.count() == 0);
+  }
+
+  SECTION("adaptors"){
+    LoopStats stats("adaptors");
+    int sum = 0;
+    for (auto [i, v]: instrumented<true>(stats, enumerate(values))) { sum += int(i) * v; }
+    for (auto [a, b]: instrumented<true>(stats, zip(values, range(5)))) { sum += a * b; }
+    REQUIRE(sum == 40 + 40);
+    REQUIRE(stats.elements == 10);
+  }
+
+  SECTION("sampling"){
+    LoopStats stats("sampling");
+    for (auto i: instrumented<true>(stats, range(100), 10)) { (void)i; }
+    REQUIRE(stats.elements == 100);
+    REQUIRE(stats.latencyNs.count() == 10);
+  }
+
+  SECTION("allocations"){
+    LoopStats stats("allocations");
+    AllocationCounter counter;
+    int sum = 0;
+    for (auto v: instrumented<true>(stats, values, 2)) { sum += v; }
+    REQUIRE(counter.allocations() == 0);
+  }
+
+  SECTION("registry output"){
+    auto &stats = Registry::global().get("output");
+    stats.reset();
+    for (auto i: instrumented<true>(stats, range(100), 1)) { (void)i; }
+    std::stringstream dump, scrape;
+    Registry::global().dump(dump);
+    Registry::global().scrape(scrape);
+    REQUIRE(dump.str().find("output\t1\t100\t") != std::string::npos);
+    REQUIRE(scrape.str().find("easy_iterator_loop_elements_total{loop=\"output\"} 100\n") != std::string::npos);
+    REQUIRE(scrape.str().find("easy_iterator_loop_element_latency_seconds_count{loop=\"output\"} 100\n") != std::string::npos);
+  }
+
+  SECTION("escaped loop names"){
+    auto &stats = Registry::global().get("say \"hi\"\\\n");
+    stats.reset();
+    for (auto i: instrumented<true>(stats, range(3))) { (void)i; }
+    std::stringstream scrape;
+    Registry::global().scrape(scrape);
+    REQUIRE(scrape.str().find("easy_iterator_loop_elements_total{loop=\"say \\\"hi\\\"\\\\\\n\"} 3\n") != std::string::npos);
+  }
+}
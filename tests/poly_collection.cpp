@@ -0,0 +1,75 @@
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+#include <easy_iterator/poly_collection.h>
+
+using namespace easy_iterator;
+
+namespace {
+
+  struct Shape {
+    virtual ~Shape() = default;
+    virtual std::string name() const = 0;
+    virtual int area() const = 0;
+  };
+
+  struct Square final: Shape {
+    int side;
+    explicit Square(int _side):side(_side){ }
+    std::string name() const override { return "square"; }
+    int area() const override { return side * side; }
+  };
+
+  struct Rectangle final: Shape {
+    int width, height;
+    Rectangle(int _width, int _height):width(_width),height(_height){ }
+    std::string name() const override { return "rectangle"; }
+    int area() const override { return width * height; }
+  };
+
+  struct Triangle final: Shape {
+    int base, height;
+    Triangle(int _base, int _height):base(_base),height(_height){ }
+    std::string name() const override { return "triangle"; }
+    int area() const override { return base * height / 2; }
+  };
+
+}
+
+TEST_CASE("poly collection", "[poly_collection]"){
+  PolyCollection<Shape, Square, Rectangle> shapes;
+  REQUIRE(shapes.empty());
+  shapes.insert(Square(2));
+  shapes.emplace<Rectangle>(2, 3);
+  shapes.insert(Triangle(4, 5));
+  shapes.insert(Square(3));
+  REQUIRE(shapes.size() == 4);
+  REQUIRE(shapes.segment<Square>().size() == 2);
+  REQUIRE(shapes.segment<Rectangle>().size() == 1);
+  REQUIRE(shapes.unregistered().size() == 1);
+
+  std::vector<std::string> names;
+  int total = 0;
+  for_each(shapes, [&](const auto &shape){
+    names.push_back(shape.name());
+    total += shape.area();
+  });
+  REQUIRE(names == std::vector<std::string>{"square", "square", "rectangle", "triangle"});
+  REQUIRE(total == 4 + 9 + 6 + 10);
+
+  size_t concrete = 0;
+  const auto &constShapes = shapes;
+  for_each(constShapes, [&](auto &shape){
+    if constexpr (!std::is_same<std::decay_t<decltype(shape)>, Shape>::value) { ++concrete; }
+  });
+  REQUIRE(concrete == 3);
+
+  shapes.for_each([](Shape &shape){
+    if (auto square = dynamic_cast<Square *>(&shape)) { square->side = 1; }
+  });
+  REQUIRE(shapes.segment<Square>()[1].area() == 1);
+
+  shapes.clear();
+  REQUIRE(shapes.empty());
+}
@@ -0,0 +1,73 @@
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/progress.h>
+
+using namespace easy_iterator;
+
+TEST_CASE("with_progress", "[progress]"){
+
+  SECTION("final report"){
+    std::vector<int> values(10000, 1);
+    std::vector<ProgressInfo> reports;
+    int sum = 0;
+    for (auto &v: with_progress(values, [&](const ProgressInfo &p){ reports.push_back(p); }, std::chrono::hours(1))) {
+      sum += v;
+    }
+    REQUIRE(sum == 10000);
+    REQUIRE(reports.size() == 1);
+    REQUIRE(reports[0].finished);
+    REQUIRE(reports[0].done == 10000);
+    REQUIRE(reports[0].total == 10000);
+    REQUIRE(reports[0].fraction() == 1);
+    REQUIRE(reports[0].etaSeconds == 0);
+  }
+
+  SECTION("unknown total"){
+    ProgressInfo last{};
+    for (auto i: with_progress(range(100), [&](const ProgressInfo &p){ last = p; })) {
+      if (i == 49) { break; }
+    }
+    REQUIRE(last.finished);
+    REQUIRE(last.done == 50);
+    REQUIRE(last.total == 0);
+    REQUIRE(last.etaSeconds < 0);
+  }
+
+  SECTION("periodic reports"){
+    std::vector<uint64_t> counts;
+    Progress periodic([&](const ProgressInfo &p){ counts.push_back(p.done); }, std::chrono::seconds(0), 100, 10);
+    for (auto i: with_progress(range(100), periodic)) { (void)i; }
+    REQUIRE(counts == std::vector<uint64_t>{10, 20, 30, 40, 50, 60, 70, 80, 90, 100});
+    periodic.finish();
+    REQUIRE(counts.size() == 11);
+  }
+
+  SECTION("parallel workers"){
+    std::atomic<int> calls{0};
+    std::atomic<bool> concurrent{false}, inCallback{false}, overcounted{false};
+    const uint64_t perWorker = 100000;
+    Progress progress([&](const ProgressInfo &p){
+      if (inCallback.exchange(true)) { concurrent = true; }
+      ++calls;
+      if (p.done > 4 * perWorker) { overcounted = true; }
+      inCallback = false;
+    }, std::chrono::seconds(0), 4 * perWorker, 1000);
+    std::vector<std::thread> workers;
+    for (auto t: range(4)) {
+      workers.emplace_back([&, t](){
+        for (auto i: with_progress(range(t * perWorker, (t + 1) * perWorker), progress)) { (void)i; }
+      });
+    }
+    for (auto &worker: workers) { worker.join(); }
+    progress.finish();
+    REQUIRE(progress.count() == 4 * perWorker);
+    REQUIRE(calls > 0);
+    REQUIRE(!concurrent);
+    REQUIRE(!overcounted);
+  }
+}
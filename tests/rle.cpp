@@ -0,0 +1,69 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/rle.h>
+#include <collect.h>
+
+using namespace easy_iterator;
+
+TEST_CASE("rle", "[rle]"){
+  std::vector<int> values{3, 1, 4, 1};
+  std::vector<uint32_t> lengths{2, 0, 3, 1};
+  auto rle = rle_view(values, lengths);
+
+  SECTION("expansion"){
+    REQUIRE(collect(rle) == std::vector<int>{3, 3, 4, 4, 4, 1});
+    REQUIRE(rle.size() == 6);
+    REQUIRE(collect(rle_view(std::vector<int>(), std::vector<int>())).empty());
+    REQUIRE(collect(rle_view(std::vector<int>{1}, std::vector<int>{0})).empty());
+  }
+
+  SECTION("encode"){
+    auto encoded = rle_encode(std::vector<std::string>{"a", "a", "b", "a", "a", "a"});
+    REQUIRE(encoded.run_values() == std::vector<std::string>{"a", "b", "a"});
+    REQUIRE(encoded.run_lengths() == std::vector<size_t>{2, 1, 3});
+    REQUIRE(collect(rle_encode(collect(rle))) == collect(rle));
+  }
+
+  SECTION("reductions"){
+    REQUIRE(sum(rle) == 3 * 2 + 4 * 3 + 1);
+    REQUIRE(count_if(rle, [](int v){ return v > 2; }) == 5);
+    REQUIRE(reduce_runs(rle, 0, [](int m, int v, uint32_t l){ return l > 0 ? std::max(m, v) : m; }) == 4);
+    REQUIRE(sum(rle_encode(range(100))) == 4950);
+    REQUIRE(sum(rle_encode(std::vector<int>{-5, -5, 1})) == -9);
+    REQUIRE(sum(rle_view(std::vector<int8_t>{-100}, std::vector<uint32_t>{3})) == -300);
+    REQUIRE(sum(rle_view(std::vector<double>{-0.5}, std::vector<size_t>{3})) == -1.5);
+  }
+
+  SECTION("filter"){
+    auto filtered = filter(rle_view(std::vector<int>{1, 2, 1, 3}, std::vector<int>{2, 5, 1, 1}), [](int v){ return v != 2; });
+    REQUIRE(filtered.run_values() == std::vector<int>{1, 3});
+    REQUIRE(filtered.run_lengths() == std::vector<int>{3, 1});
+    REQUIRE(collect(filtered) == std::vector<int>{1, 1, 1, 3});
+  }
+
+  SECTION("copy and fill"){
+    std::vector<int> expanded(6);
+    easy_iterator::copy(rle, expanded);
+    REQUIRE(expanded == std::vector<int>{3, 3, 4, 4, 4, 1});
+    easy_iterator::copy(rle, expanded, [](int v){ return -v; });
+    REQUIRE(expanded == std::vector<int>{-3, -3, -4, -4, -4, -1});
+    easy_iterator::fill(rle, 7);
+    REQUIRE(values == std::vector<int>{7, 7, 7, 7});
+    REQUIRE(collect(rle) == std::vector<int>(6, 7));
+  }
+
+  SECTION("zip runs"){
+    auto categories = rle_view(std::vector<char>{'x', 'y'}, std::vector<int>{4, 2});
+    std::vector<std::tuple<int, char, size_t>> runs;
+    for (auto [value, category, length]: zip_runs(rle, categories)) { runs.emplace_back(value, category, length); }
+    REQUIRE(runs == std::vector<std::tuple<int, char, size_t>>{{3, 'x', 2}, {4, 'x', 2}, {4, 'y', 1}, {1, 'y', 1}});
+    size_t total = 0;
+    for (auto [a, b, length]: zip_runs(rle, rle)) { REQUIRE(a == b); total += length; }
+    REQUIRE(total == 6);
+  }
+}
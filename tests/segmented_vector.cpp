@@ -0,0 +1,82 @@
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/segmented_vector.h>
+
+using namespace easy_iterator;
+
+TEST_CASE("segmented vector", "[segmented_vector]"){
+  SegmentedVector<std::string, 4> vector;
+  REQUIRE(vector.empty());
+  REQUIRE(vector.begin() == vector.end());
+
+  std::vector<std::string> expected;
+  for (auto i: range(100)) {
+    expected.push_back(std::to_string(i));
+    vector.push_back(expected.back());
+  }
+  auto &first = vector[0];
+  vector.emplace_back(3, 'x');
+  expected.emplace_back(3, 'x');
+  REQUIRE(&first == &vector[0]);
+  REQUIRE(vector.size() == 101);
+  REQUIRE(vector[100] == "xxx");
+
+  std::vector<std::string> iterated;
+  for (auto &v: vector) { iterated.push_back(v); }
+  REQUIRE(iterated == expected);
+
+  std::vector<size_t> segmentSizes;
+  for (auto segment: vector.segments()) { segmentSizes.push_back(segment.size()); }
+  REQUIRE(segmentSizes == std::vector<size_t>{4, 8, 16, 32, 41});
+
+  size_t index = 0;
+  for_each(vector, [&](const std::string &v){ REQUIRE(v == expected[index++]); });
+  REQUIRE(index == 101);
+
+  REQUIRE(SegmentedVector<int>::locate(0) == std::make_pair(size_t(0), size_t(0)));
+  REQUIRE(SegmentedVector<int>::locate(15) == std::make_pair(size_t(0), size_t(15)));
+  REQUIRE(SegmentedVector<int>::locate(16) == std::make_pair(size_t(1), size_t(0)));
+  REQUIRE(SegmentedVector<int>::locate(47) == std::make_pair(size_t(1), size_t(31)));
+  REQUIRE(SegmentedVector<int>::locate(48) == std::make_pair(size_t(2), size_t(0)));
+}
+
+TEST_CASE("segmented vector destroys elements", "[segmented_vector]"){
+  auto counter = std::make_shared<int>();
+  {
+    SegmentedVector<std::shared_ptr<int>, 2> vector;
+    for (auto i: range(9)) { (void)i; vector.push_back(counter); }
+    REQUIRE(counter.use_count() == 10);
+  }
+  REQUIRE(counter.use_count() == 1);
+}
+
+TEST_CASE("segmented vector concurrent append", "[segmented_vector]"){
+  SegmentedVector<size_t> vector;
+  const size_t total = 200000;
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> readers;
+  for (auto r: range(3)) {
+    (void)r;
+    readers.emplace_back([&](){
+      size_t previous = 0;
+      while (previous < total) {
+        size_t seen = 0;
+        for_each(vector, [&](size_t v){ failed = failed || v != seen; ++seen; });
+        size_t iterated = 0;
+        for (auto v: vector) { failed = failed || v != iterated; ++iterated; }
+        failed = failed || seen < previous || iterated < seen;
+        previous = iterated;
+      }
+    });
+  }
+  for (auto i: range(total)) { vector.push_back(i); }
+  for (auto &reader: readers) { reader.join(); }
+  REQUIRE(!failed);
+  REQUIRE(vector.size() == total);
+}
@@ -0,0 +1,142 @@
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/shard.h>
+
+using namespace easy_iterator;
+
+namespace {
+
+  struct Naturals {
+    uint64_t current = 0;
+    bool advance(){ return ++current < 1000; }
+    uint64_t value(){ return current; }
+  };
+
+  struct SkippableNaturals {
+    uint64_t current = 0;
+    bool advance(){ return ++current < 1000; }
+    uint64_t value(){ return current; }
+    std::pair<bool, size_t> skip(size_t n){
+      auto skipped = std::min<uint64_t>(n, 1000 - current);
+      current += skipped;
+      return std::make_pair(current < 1000, static_cast<size_t>(skipped));
+    }
+  };
+
+  /**
+   * Collects all shards and checks that they are disjoint and cover `expected`.
+   */
+  template <class F> void requirePartition(size_t shardCount, const std::vector<uint64_t> &expected, F && makeShard) {
+    std::vector<uint64_t> all;
+    for (auto id: range(shardCount)) {
+      for (auto v: makeShard(id)) { all.push_back(static_cast<uint64_t>(v)); }
+    }
+    std::sort(all.begin(), all.end());
+    REQUIRE(all == expected);
+  }
+
+  std::vector<uint64_t> iota(uint64_t n) {
+    std::vector<uint64_t> values;
+    for (auto i: range(n)) { values.push_back(i); }
+    return values;
+  }
+
+}
+
+TEST_CASE("shard", "[shard]"){
+
+  SECTION("contiguous range"){
+    std::vector<int> values;
+    for (auto i: shard(range(10), 1, 3)) { values.push_back(i); }
+    REQUIRE(values == std::vector<int>{3, 4, 5});
+    for (size_t count: {1, 2, 3, 7, 10, 13}) {
+      requirePartition(count, iota(10), [&](size_t id){ return shard(range(uint64_t(10)), id, count); });
+    }
+  }
+
+  SECTION("contiguous container and zip"){
+    std::vector<uint64_t> values = iota(100);
+    requirePartition(7, values, [&](size_t id){ return shard(values, id, 7); });
+    std::vector<uint64_t> sums;
+    for (auto [a, b]: shard(zip(values, range(uint64_t(100), uint64_t(200))), 3, 4)) { sums.push_back(a + b); }
+    REQUIRE(sums.size() == 25);
+    REQUIRE(sums.front() == 75 + 175);
+    std::vector<uint64_t> doubled;
+    for (auto v: values) { doubled.push_back(2 * v); }
+    std::vector<uint64_t> firsts;
+    for (auto [a, b]: shard(zip(values, doubled), 1, 2)) {
+      REQUIRE(b == 2 * a);
+      firsts.push_back(a);
+    }
+    REQUIRE(firsts.size() == 50);
+    REQUIRE(firsts.front() == 50);
+    std::vector<int> indices;
+    for (auto [i, v]: shard(enumerate(values), 2, 4)) {
+      REQUIRE(uint64_t(i) == v);
+      indices.push_back(i);
+    }
+    REQUIRE(indices.size() == 25);
+    REQUIRE(indices.front() == 50);
+  }
+
+  SECTION("round-robin blocks"){
+    std::vector<int> values;
+    for (auto i: shard(range(20), 1, 3, ShardBlocks{2})) { values.push_back(i); }
+    REQUIRE(values == std::vector<int>{2, 3, 8, 9, 14, 15});
+    for (size_t count: {1, 2, 5, 30}) {
+      for (size_t block: {1, 3, 16}) {
+        requirePartition(count, iota(20), [&](size_t id){ return shard(range(uint64_t(20)), id, count, ShardBlocks{block}); });
+      }
+    }
+  }
+
+  SECTION("generators"){
+    requirePartition(4, iota(1000), [](size_t id){ return shard(MakeIterable<Naturals>(), id, 4, ShardBlocks{10}); });
+    requirePartition(4, iota(1000), [](size_t id){ return shard(MakeIterable<SkippableNaturals>(), id, 4, ShardBlocks{10}); });
+  }
+
+  SECTION("key hash"){
+    std::vector<std::string> names{"a", "b", "c", "d", "e", "f", "g", "h", "a", "b"};
+    std::vector<std::string> all;
+    for (auto id: range(3)) {
+      std::vector<std::string> shardNames;
+      for (auto &name: shard_by_key(names, id, 3, [](const std::string &s){ return s; })) { shardNames.push_back(name); }
+      // equal keys end up in the same shard
+      REQUIRE(std::count(shardNames.begin(), shardNames.end(), "a") % 2 == 0);
+      all.insert(all.end(), shardNames.begin(), shardNames.end());
+    }
+    std::sort(all.begin(), all.end());
+    auto sorted = names;
+    std::sort(sorted.begin(), sorted.end());
+    REQUIRE(all == sorted);
+    requirePartition(5, iota(100), [](size_t id){ return shard_by_key(range(uint64_t(100)), id, 5, [](uint64_t v){ return v; }); });
+    auto pointHash = [](const std::pair<int, int> &p){ return stableHash(p.first) ^ stableHash(p.second) * 3; };
+    requirePartition(3, iota(100), [&](size_t id){
+      return shard_by_key(range(uint64_t(100)), id, 3, [](uint64_t v){ return std::make_pair(int(v), int(v % 7)); }, pointHash);
+    });
+  }
+
+  SECTION("invalid shards"){
+    std::vector<int> values{1, 2, 3};
+    REQUIRE_THROWS_AS(shard(values, 0, 0), std::invalid_argument);
+    REQUIRE_THROWS_AS(shard(values, 3, 3), std::invalid_argument);
+    REQUIRE_THROWS_AS(shard(values, 1, 1, ShardBlocks{2}), std::invalid_argument);
+    REQUIRE_THROWS_AS(shard_by_key(values, 0, 0, [](int v){ return v; }), std::invalid_argument);
+  }
+
+  SECTION("stable hash"){
+    REQUIRE(stableHash(std::string("")) == 0xcbf29ce484222325ULL);
+    REQUIRE(stableHash("a") == 0xaf63dc4c8601ec8cULL);
+    REQUIRE(stableHash(std::string("a")) == stableHash("a"));
+    REQUIRE(stableHash(0) == 0);
+    REQUIRE(stableHash(1) == stableHash(uint64_t(1)));
+    REQUIRE(stableHash(1) != stableHash(2));
+  }
+}
@@ -0,0 +1,73 @@
+#include <catch2/catch.hpp>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/slot_map.h>
+
+using namespace easy_iterator;
+
+TEST_CASE("slot map", "[slot_map]"){
+  SlotMap<std::string> map;
+  auto a = map.insert("a");
+  auto b = map.insert("b");
+  auto c = map.emplace(2, 'c');
+  REQUIRE(map.size() == 3);
+  REQUIRE(map[b] == "b");
+  REQUIRE(map.at(c) == "cc");
+
+  REQUIRE(map.erase(a));
+  REQUIRE(!map.erase(a));
+  REQUIRE(!map.contains(a));
+  REQUIRE(map.find(a) == nullptr);
+  REQUIRE_THROWS_AS(map.at(a), std::out_of_range);
+  REQUIRE(!map.contains(SlotHandle()));
+
+  auto d = map.insert("d");
+  REQUIRE(d.index == a.index);
+  REQUIRE(d != a);
+  REQUIRE(!map.contains(a));
+  REQUIRE(*map.find(d) == "d");
+
+  std::vector<std::string> values(map.begin(), map.end());
+  REQUIRE(values == std::vector<std::string>{"cc", "b", "d"});
+  for (auto [handle, value]: zip(map.handles(), map.values())) {
+    REQUIRE(map[handle] == value);
+    value += "!";
+  }
+  REQUIRE(map[b] == "b!");
+
+  map.clear();
+  REQUIRE(map.empty());
+  REQUIRE(!map.contains(b));
+  REQUIRE(map.insert("e").index != map.insert("f").index);
+}
+
+TEST_CASE("slot map random operations", "[slot_map]"){
+  SlotMap<int> map;
+  std::map<int, SlotHandle> reference;
+  std::vector<SlotHandle> erased;
+  std::mt19937 engine(3);
+  for (auto i: range(5000)) {
+    if (reference.empty() || engine() % 3 != 0) {
+      reference[i] = map.insert(i);
+    } else {
+      auto it = reference.lower_bound(static_cast<int>(engine() % static_cast<unsigned>(i)));
+      if (it == reference.end()) { it = reference.begin(); }
+      REQUIRE(map.erase(it->second));
+      erased.push_back(it->second);
+      reference.erase(it);
+    }
+  }
+  REQUIRE(map.size() == reference.size());
+  for (auto &[value, handle]: reference) { REQUIRE(map.at(handle) == value); }
+  for (auto &handle: erased) { REQUIRE(!map.contains(handle)); }
+  size_t count = 0;
+  for (auto [handle, value]: zip(map.handles(), map.values())) {
+    REQUIRE(reference.at(value) == handle);
+    ++count;
+  }
+  REQUIRE(count == reference.size());
+}
@@ -0,0 +1,81 @@
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/stepper.h>
+
+using namespace easy_iterator;
+
+TEST_CASE("stepper", "[stepper]"){
+
+  SECTION("element budget"){
+    std::vector<int> values;
+    auto s = stepper(range(10), [&](int i){ values.push_back(i); });
+    REQUIRE(!s.done());
+    REQUIRE(s.run_for(3) == 3);
+    REQUIRE(values == std::vector<int>{0, 1, 2});
+    REQUIRE(s.run_for(0) == 0);
+    REQUIRE(s.run_for(4) == 4);
+    REQUIRE(s.position() == 7);
+    REQUIRE(s.run_for(100) == 3);
+    REQUIRE(s.done());
+    REQUIRE(s.run_for(1) == 0);
+    REQUIRE(values == std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  }
+
+  SECTION("unbound function"){
+    std::vector<int> values{1, 2, 3, 4, 5};
+    auto s = stepper(values);
+    s.run_for(2, [](int &v){ v *= 10; });
+    s.run_for(10, [](int &v){ v = -v; });
+    REQUIRE(values == std::vector<int>{10, 20, -3, -4, -5});
+  }
+
+  SECTION("zip and MakeIterable"){
+    std::vector<int> a{1, 2, 3}, b{4, 5, 6};
+    int sum = 0;
+    auto zipped = stepper(zip(a, b), [&](auto v){ sum += std::get<0>(v) * std::get<1>(v); });
+    zipped.run_for(1);
+    REQUIRE(sum == 4);
+    zipped.run_for(5);
+    REQUIRE(sum == 4 + 10 + 18);
+
+    struct Countdown {
+      int current = 5;
+      bool advance(){ return --current > 0; }
+      int value(){ return current; }
+    };
+    std::vector<int> values;
+    auto counting = stepper(MakeIterable<Countdown>(), [&](int v){ values.push_back(v); });
+    counting.run_for(2);
+    counting.run_for(2);
+    REQUIRE(values == std::vector<int>{5, 4, 3, 2});
+    REQUIRE(!counting.done());
+    counting.run_for(2);
+    REQUIRE(counting.done());
+    REQUIRE(values == std::vector<int>{5, 4, 3, 2, 1});
+  }
+
+  SECTION("empty"){
+    auto s = stepper(range(0), [](int){ FAIL("should not be called"); });
+    REQUIRE(s.done());
+    REQUIRE(s.run_for(std::chrono::milliseconds(1)) == 0);
+  }
+
+  SECTION("time budget"){
+    uint64_t sum = 0;
+    auto s = stepper(range(uint64_t(0), ~uint64_t(0)), [&](uint64_t i){ sum += i; });
+    auto start = std::chrono::steady_clock::now();
+    auto first = s.run_for(std::chrono::milliseconds(2));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(first > 0);
+    REQUIRE(elapsed >= std::chrono::milliseconds(2));
+    REQUIRE(elapsed < std::chrono::milliseconds(200));
+    auto second = s.run_for(std::chrono::milliseconds(1));
+    REQUIRE(second > 0);
+    REQUIRE(s.position() == first + second);
+    REQUIRE(sum == (first + second) * (first + second - 1) / 2);
+  }
+}
@@ -0,0 +1,146 @@
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/stop.h>
+
+using namespace easy_iterator;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+  auto endless() {
+    return range(uint64_t(0), ~uint64_t(0));
+  }
+}
+
+TEST_CASE("until", "[stop]"){
+  std::vector<int> values{1, 2, 3, 4, 5};
+
+  SECTION("passed deadline"){
+    auto loop = until(values, Clock::now() - std::chrono::seconds(1));
+    for (auto v: loop) { (void)v; FAIL("should not iterate"); }
+    REQUIRE(loop.stopped());
+    auto empty = until(std::vector<int>(), Clock::now() - std::chrono::seconds(1));
+    for (auto v: empty) { (void)v; FAIL("should not iterate"); }
+    REQUIRE(!empty.stopped());
+  }
+
+  SECTION("future deadline"){
+    auto loop = until(values, Clock::now() + std::chrono::hours(1));
+    int sum = 0;
+    for (auto &v: loop) { sum += v; }
+    REQUIRE(sum == 15);
+    REQUIRE(!loop.stopped());
+  }
+
+  SECTION("endless iteration"){
+    auto start = Clock::now();
+    auto loop = until(endless(), start + std::chrono::milliseconds(5));
+    uint64_t count = 0;
+    for (auto i: loop) { count += i > 0; }
+    auto elapsed = Clock::now() - start;
+    REQUIRE(loop.stopped());
+    REQUIRE(count > 0);
+    REQUIRE(elapsed >= std::chrono::milliseconds(5));
+    REQUIRE(elapsed < std::chrono::milliseconds(500));
+  }
+
+  SECTION("custom iterable"){
+    struct Counter {
+      int current = 0;
+      bool advance(){ ++current; return true; }
+      int value(){ return current; }
+    };
+    auto loop = until(MakeIterable<Counter>(), Clock::now() + std::chrono::milliseconds(1));
+    int last = 0;
+    for (auto v: loop) { last = v; }
+    REQUIRE(loop.stopped());
+    REQUIRE(last > 0);
+  }
+}
+
+TEST_CASE("cancellable", "[stop]"){
+
+  SECTION("tokens"){
+    StopToken empty;
+    REQUIRE(!empty.stop_possible());
+    REQUIRE(!empty.stop_requested());
+    StopSource source;
+    auto token = source.get_token();
+    REQUIRE(token.stop_possible());
+    REQUIRE(!token.stop_requested());
+    REQUIRE(source.request_stop());
+    REQUIRE(!source.request_stop());
+    REQUIRE(token.stop_requested());
+    REQUIRE(source.stop_requested());
+  }
+
+  SECTION("stop from the loop body"){
+    StopSource source;
+    auto loop = cancellable(endless(), source.get_token());
+    uint64_t last = 0;
+    for (auto i: loop) {
+      last = i;
+      if (i == 1000) { source.request_stop(); }
+    }
+    REQUIRE(loop.stopped());
+    REQUIRE(last >= 1000);
+    REQUIRE(last <= 1000 + stop_detail::AdaptiveInterval::maxInterval);
+  }
+
+  SECTION("without stop"){
+    StopSource source;
+    auto loop = cancellable(range(100), source.get_token());
+    int count = 0;
+    for (auto i: loop) { (void)i; ++count; }
+    REQUIRE(count == 100);
+    REQUIRE(!loop.stopped());
+  }
+
+  SECTION("stop after the last element"){
+    StopSource source;
+    auto loop = cancellable(range(3), source.get_token());
+    int count = 0;
+    for (auto i: loop) {
+      ++count;
+      if (i == 2) { source.request_stop(); }
+    }
+    REQUIRE(count == 3);
+    REQUIRE(!loop.stopped());
+  }
+
+  SECTION("parallel workers"){
+    StopSource source;
+    std::atomic<int> started{0}, stopped{0};
+    std::vector<std::thread> workers;
+    for (auto t: range(4)) {
+      (void)t;
+      workers.emplace_back([&, token = source.get_token()](){
+        auto loop = cancellable(endless(), token);
+        bool first = true;
+        for (auto i: loop) {
+          (void)i;
+          if (first) { ++started; first = false; }
+        }
+        stopped += loop.stopped();
+      });
+    }
+    while (started < 4) { std::this_thread::yield(); }
+    source.request_stop();
+    for (auto &worker: workers) { worker.join(); }
+    REQUIRE(stopped == 4);
+  }
+}
+
+TEST_CASE("AdaptiveInterval", "[stop]"){
+  stop_detail::AdaptiveInterval interval;
+  Clock::time_point now;
+  uint64_t checks = 0;
+  for (auto i: range(100000)) { (void)i; checks += interval.step(now); }
+  REQUIRE(interval.current() > 1);
+  REQUIRE(checks < 100000 / 4);
+}
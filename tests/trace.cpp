@@ -0,0 +1,113 @@
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <easy_iterator.h>
+#include <easy_iterator/instrumentation.h>
+#include <easy_iterator/trace.h>
+
+using namespace easy_iterator;
+
+namespace {
+  size_t countOccurrences(const std::string &str, const std::string &pattern) {
+    size_t count = 0;
+    for (auto pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1)) { ++count; }
+    return count;
+  }
+}
+
+TEST_CASE("ThreadBuffer", "[trace]"){
+  trace::ThreadBuffer buffer(1);
+  for (auto i: range(trace::ThreadBuffer::capacity)) {
+    REQUIRE(buffer.push({"event", uint64_t(i), 'B'}));
+  }
+  REQUIRE(!buffer.push({"event", 0, 'B'}));
+  uint64_t expected = 0;
+  buffer.drain([&](const trace::Event &event){ REQUIRE(event.ns == expected++); });
+  REQUIRE(expected == trace::ThreadBuffer::capacity);
+  REQUIRE(buffer.push({"event", 0, 'E'}));
+  buffer.clear();
+  buffer.drain([](const trace::Event &){ FAIL("buffer should be empty"); });
+}
+
+TEST_CASE("Tracer", "[trace]"){
+  auto &tracer = trace::Tracer::global();
+
+  SECTION("disabled"){
+    REQUIRE(!tracer.enabled());
+    trace::Span span("ignored");
+  }
+
+  SECTION("spans and loops"){
+    std::stringstream stream;
+    tracer.start(stream, std::chrono::milliseconds(1));
+    REQUIRE(tracer.enabled());
+    std::vector<std::thread> threads;
+    std::atomic<int> ready{0};
+    for (auto t: range(4)) {
+      (void)t;
+      threads.emplace_back([&](){
+        for (auto i: range(100)) {
+          (void)i;
+          trace::Span span("chunk \"quoted\"");
+        }
+        // keep every thread alive until all have recorded, so no buffer is reused
+        ++ready;
+        while (ready < 4) { std::this_thread::yield(); }
+      });
+    }
+    for (auto &thread: threads) { thread.join(); }
+    auto &stats = instrumentation::Registry::global().get("traced loop");
+    for (auto i: instrumented<true>(stats, range(10))) { (void)i; }
+    tracer.stop();
+    REQUIRE(!tracer.enabled());
+
+    auto json = stream.str();
+    REQUIRE(json.rfind("{\"traceEvents\":[", 0) == 0);
+    REQUIRE(json.find("\"dropped_events\":0}}") != std::string::npos);
+    REQUIRE(countOccurrences(json, "\"name\":\"chunk \\\"quoted\\\"\",\"ph\":\"B\"") == 400);
+    REQUIRE(countOccurrences(json, "\"name\":\"chunk \\\"quoted\\\"\",\"ph\":\"E\"") == 400);
+    REQUIRE(countOccurrences(json, "\"name\":\"traced loop\",\"ph\":\"B\"") == 1);
+    REQUIRE(countOccurrences(json, "\"name\":\"traced loop\",\"ph\":\"E\"") == 1);
+
+    std::set<std::string> threadIds;
+    for (auto pos = json.find("\"tid\":"); pos != std::string::npos; pos = json.find("\"tid\":", pos + 1)) {
+      threadIds.insert(json.substr(pos + 6, json.find('}', pos) - pos - 6));
+    }
+    REQUIRE(threadIds.size() >= 4);
+  }
+
+  SECTION("restart"){
+    std::stringstream first, second;
+    tracer.start(first);
+    trace::begin("first");
+    tracer.start(second);
+    trace::end("second");
+    tracer.stop();
+    REQUIRE(first.str().find("\"first\"") != std::string::npos);
+    REQUIRE(first.str().find("\"dropped_events\"") != std::string::npos);
+    REQUIRE(second.str().find("\"first\"") == std::string::npos);
+    REQUIRE(second.str().find("\"second\"") != std::string::npos);
+  }
+
+  SECTION("restart while recording"){
+    std::atomic<bool> done{false};
+    std::thread recorder([&](){
+      while (!done) { trace::Span span("concurrent"); }
+    });
+    for (auto i: range(20)) {
+      (void)i;
+      std::stringstream stream;
+      tracer.start(stream, std::chrono::milliseconds(1));
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      tracer.stop();
+      REQUIRE(stream.str().find("\"dropped_events\"") != std::string::npos);
+    }
+    done = true;
+    recorder.join();
+  }
+}